@@ -0,0 +1,83 @@
+#include "batchexport.h"
+#include "widgets/graphview/disassemblergraphview/disassemblergraphview.h"
+#include "models/disassemblermodel.h"
+#include "databaseloader.h"
+#include <redasm/disassembler/disassembler.h>
+#include <redasm/plugins/plugins.h>
+#include <QStandardPaths>
+#include <QTextStream>
+#include <QDir>
+
+#define BATCH_EXPORT_ARG  "--export-graph"
+#define BATCH_VIEW_WIDTH  1280
+#define BATCH_VIEW_HEIGHT 800
+
+static bool resolveAddress(const REDasm::DisassemblerPtr& disassembler, const QString& s, address_t* address)
+{
+    bool ok = false;
+    *address = s.startsWith("0x", Qt::CaseInsensitive) ? s.mid(2).toULongLong(&ok, 16) : s.toULongLong(&ok, 16);
+
+    if(ok)
+        return true;
+
+    const REDasm::Symbol* symbol = disassembler->document()->symbol(s.toStdString());
+
+    if(!symbol)
+        return false;
+
+    *address = symbol->address;
+    return true;
+}
+
+bool BatchExport::isRequested(const QStringList &args) { return (args.size() == 5) && (args[1] == BATCH_EXPORT_ARG); }
+
+int BatchExport::run(const QStringList &args)
+{
+    QTextStream out(stdout), err(stderr);
+
+    REDasm::ContextSettings ctxsettings;
+    ctxsettings.tempPath = QStandardPaths::writableLocation(QStandardPaths::TempLocation).toStdString();
+    ctxsettings.searchPath = QDir::currentPath().toStdString();
+    ctxsettings.logCallback = [&](const std::string& s) { out << S_TO_QS(s) << endl; };
+    ctxsettings.statusCallback = [&](const std::string&) { };
+    ctxsettings.progressCallback = [&](size_t) { };
+    REDasm::init(ctxsettings);
+
+    DatabaseLoader loader(QString::fromStdString(ctxsettings.tempPath));
+    REDasm::Disassembler* d = loader.load(args[2]);
+
+    if(!d)
+    {
+        err << "Cannot load " << args[2] << ": " << loader.lastError() << endl;
+        return 1;
+    }
+
+    REDasm::DisassemblerPtr disassembler(d);
+    address_t address = 0;
+
+    if(!resolveAddress(disassembler, args[3], &address))
+    {
+        err << "Cannot find " << args[3] << endl;
+        return 1;
+    }
+
+    QWidget host; // Never shown, it just gives the graph a viewport
+    host.resize(BATCH_VIEW_WIDTH, BATCH_VIEW_HEIGHT);
+
+    DisassemblerGraphView* graphview = new DisassemblerGraphView(&host);
+    graphview->resize(host.size());
+    graphview->setDisassembler(disassembler);
+    graphview->goTo(address);
+
+    if(!graphview->graph())
+    {
+        err << "Cannot build a graph @ " << args[3] << endl;
+        return 1;
+    }
+
+    if(!graphview->exportGraph(args[4]))
+        return 1;
+
+    out << "Graph exported to " << args[4] << endl;
+    return 0;
+}
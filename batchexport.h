@@ -0,0 +1,16 @@
+#ifndef BATCHEXPORT_H
+#define BATCHEXPORT_H
+
+#include <QStringList>
+
+// Headless graph export:
+//   REDasm --export-graph <database.rdb> <address|symbol> <output.png|output.svg>
+// Run it with QT_QPA_PLATFORM=offscreen on machines without a display.
+class BatchExport
+{
+    public:
+        static bool isRequested(const QStringList& args);
+        static int run(const QStringList& args);
+};
+
+#endif // BATCHEXPORT_H
@@ -0,0 +1,224 @@
+#include "chunkedfile.h"
+#include <QtConcurrent>
+#include <QDataStream>
+#include <QSaveFile>
+#include <QtEndian>
+#include <cstring>
+
+#define CHUNKEDFILE_MAGIC      "RDBZ"
+#define CHUNKEDFILE_VERSION    1
+#define CHUNKEDFILE_HEADER     16
+#define CHUNKEDFILE_TRAILER    16
+#define CHUNKEDFILE_INDEX_ITEM 16
+#define CHUNKEDFILE_CHUNK_SIZE (1024 * 1024)
+#define CHUNKEDFILE_GROUP_SIZE 32 // Chunks held in memory at once
+#define CHUNKEDFILE_LEVEL      6
+
+ChunkedFile::ChunkedFile(): m_size(0), m_chunksize(0) { }
+
+bool ChunkedFile::open(const QString &filepath)
+{
+    m_file.close();
+    m_file.setFileName(filepath);
+    m_index.clear();
+    m_size = 0;
+
+    if(!m_file.open(QFile::ReadOnly))
+        return this->fail("Cannot read " + filepath + ": " + m_file.errorString());
+
+    QByteArray header = m_file.read(CHUNKEDFILE_HEADER);
+
+    if((header.size() != CHUNKEDFILE_HEADER) || memcmp(header.constData(), CHUNKEDFILE_MAGIC, 4) || (m_file.size() < (CHUNKEDFILE_HEADER + CHUNKEDFILE_TRAILER)))
+        return this->fail(filepath + " is not a compressed database");
+
+    if(qFromLittleEndian<quint32>(header.constData() + 4) != CHUNKEDFILE_VERSION)
+        return this->fail("Unsupported compressed database version");
+
+    m_chunksize = qFromLittleEndian<quint32>(header.constData() + 8);
+    m_file.seek(m_file.size() - CHUNKEDFILE_TRAILER);
+
+    QByteArray trailer = m_file.read(CHUNKEDFILE_TRAILER);
+    quint64 indexoffset = qFromLittleEndian<quint64>(trailer.constData());
+    quint32 count = qFromLittleEndian<quint32>(trailer.constData() + 8);
+    quint64 indexend = static_cast<quint64>(m_file.size() - CHUNKEDFILE_TRAILER);
+
+    // Truncated files (interrupted copies) are detected here
+    if(memcmp(trailer.constData() + 12, CHUNKEDFILE_MAGIC, 4) || !m_chunksize || (indexoffset < CHUNKEDFILE_HEADER) ||
+       (indexoffset > indexend) || (((indexend - indexoffset) / CHUNKEDFILE_INDEX_ITEM) != count))
+        return this->fail(filepath + " is damaged");
+
+    m_file.seek(static_cast<qint64>(indexoffset));
+    QByteArray index = m_file.read(static_cast<qint64>(count) * CHUNKEDFILE_INDEX_ITEM);
+    m_index.reserve(static_cast<int>(count));
+
+    for(quint32 i = 0; i < count; i++)
+    {
+        const char* item = index.constData() + (i * CHUNKEDFILE_INDEX_ITEM);
+        Chunk chunk = { qFromLittleEndian<quint64>(item), qFromLittleEndian<quint32>(item + 8), qFromLittleEndian<quint32>(item + 12) };
+
+        // Every chunk but the last one is full: offsets map to chunks by division
+        if((chunk.offset + chunk.size > indexoffset) || (chunk.rawsize > m_chunksize) || ((i < count - 1) && (chunk.rawsize != m_chunksize)))
+            return this->fail(filepath + " is damaged");
+
+        m_index.push_back(chunk);
+        m_size += chunk.rawsize;
+    }
+
+    return true;
+}
+
+bool ChunkedFile::compress(const QString &inpath, const QString &outpath, const ProgressCallback &cb)
+{
+    QFile infile(inpath);
+
+    if(!infile.open(QFile::ReadOnly))
+        return this->fail("Cannot read " + inpath + ": " + infile.errorString());
+
+    QSaveFile outfile(outpath);
+
+    if(!outfile.open(QFile::WriteOnly))
+        return this->fail("Cannot write " + outpath + ": " + outfile.errorString());
+
+    QDataStream stream(&outfile);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.writeRawData(CHUNKEDFILE_MAGIC, 4);
+    stream << static_cast<quint32>(CHUNKEDFILE_VERSION) << static_cast<quint32>(CHUNKEDFILE_CHUNK_SIZE) << static_cast<quint32>(0);
+
+    QVector<Chunk> index;
+    quint64 offset = CHUNKEDFILE_HEADER;
+
+    while(!infile.atEnd())
+    {
+        QVector<QByteArray> group;
+
+        while(!infile.atEnd() && (group.size() < CHUNKEDFILE_GROUP_SIZE))
+            group.push_back(infile.read(CHUNKEDFILE_CHUNK_SIZE));
+
+        if(infile.error() != QFile::NoError)
+            return this->fail("Cannot read " + inpath + ": " + infile.errorString());
+
+        QVector<QByteArray> compressed = QtConcurrent::blockingMapped< QVector<QByteArray> >(group, [](const QByteArray& raw) -> QByteArray {
+            return qCompress(raw, CHUNKEDFILE_LEVEL);
+        });
+
+        for(int i = 0; i < compressed.size(); i++)
+        {
+            stream.writeRawData(compressed[i].constData(), compressed[i].size());
+            index.push_back({ offset, static_cast<quint32>(compressed[i].size()), static_cast<quint32>(group[i].size()) });
+            offset += static_cast<quint64>(compressed[i].size());
+        }
+
+        if(cb)
+            cb(static_cast<int>((infile.pos() * 100) / std::max<qint64>(infile.size(), 1)), 100);
+    }
+
+    for(const Chunk& chunk : index)
+        stream << static_cast<quint64>(chunk.offset) << chunk.size << chunk.rawsize;
+
+    stream << static_cast<quint64>(offset) << static_cast<quint32>(index.size());
+    stream.writeRawData(CHUNKEDFILE_MAGIC, 4);
+
+    if((stream.status() != QDataStream::Ok) || !outfile.commit())
+        return this->fail("Cannot write " + outpath + ": " + outfile.errorString());
+
+    return true;
+}
+
+bool ChunkedFile::extract(const QString &outpath, const ProgressCallback &cb)
+{
+    QSaveFile outfile(outpath);
+
+    if(!outfile.open(QFile::WriteOnly))
+        return this->fail("Cannot write " + outpath + ": " + outfile.errorString());
+
+    for(int i = 0; i < m_index.size(); i += CHUNKEDFILE_GROUP_SIZE)
+    {
+        QVector<QByteArray> group = this->chunks(i, std::min(i + CHUNKEDFILE_GROUP_SIZE, m_index.size()));
+
+        if(group.empty())
+            return false;
+
+        for(const QByteArray& raw : group)
+        {
+            if(outfile.write(raw) != raw.size())
+                return this->fail("Cannot write " + outpath + ": " + outfile.errorString());
+        }
+
+        if(cb)
+            cb(std::min(i + CHUNKEDFILE_GROUP_SIZE, m_index.size()), m_index.size());
+    }
+
+    if(!outfile.commit())
+        return this->fail("Cannot write " + outpath + ": " + outfile.errorString());
+
+    return true;
+}
+
+QByteArray ChunkedFile::read(quint64 offset, quint64 size)
+{
+    if(offset >= m_size)
+        return QByteArray();
+
+    size = std::min(size, m_size - offset);
+
+    if(!size)
+        return QByteArray();
+
+    int first = static_cast<int>(offset / m_chunksize), last = static_cast<int>((offset + size - 1) / m_chunksize) + 1;
+    QByteArray data;
+
+    for(const QByteArray& raw : this->chunks(first, last)) // Only the chunks that overlap the range
+        data += raw;
+
+    return data.mid(static_cast<int>(offset - (static_cast<quint64>(first) * m_chunksize)), static_cast<int>(size));
+}
+
+QByteArray ChunkedFile::chunk(int index) { return this->chunks(index, index + 1).value(0); }
+quint64 ChunkedFile::size() const { return m_size; }
+int ChunkedFile::count() const { return m_index.size(); }
+
+bool ChunkedFile::isChunked(const QString &filepath)
+{
+    QFile file(filepath);
+
+    if(!file.open(QFile::ReadOnly))
+        return false;
+
+    return file.read(4) == CHUNKEDFILE_MAGIC;
+}
+
+QVector<QByteArray> ChunkedFile::chunks(int first, int last)
+{
+    QVector<QByteArray> compressed;
+
+    for(int i = first; i < last; i++) // Reads stay sequential, inflating is parallel
+    {
+        const Chunk& chunk = m_index[i];
+
+        if(!m_file.seek(static_cast<qint64>(chunk.offset)))
+            break;
+
+        compressed.push_back(m_file.read(chunk.size));
+    }
+
+    QVector<QByteArray> raw = QtConcurrent::blockingMapped< QVector<QByteArray> >(compressed, [](const QByteArray& data) -> QByteArray {
+        return qUncompress(data);
+    });
+
+    for(int i = 0; i < raw.size(); i++)
+    {
+        if(static_cast<quint32>(raw[i].size()) != m_index[first + i].rawsize)
+        {
+            this->fail(m_file.fileName() + " is damaged");
+            return QVector<QByteArray>();
+        }
+    }
+
+    if(raw.size() != (last - first))
+    {
+        this->fail("Cannot read " + m_file.fileName() + ": " + m_file.errorString());
+        return QVector<QByteArray>();
+    }
+
+    return raw;
+}
@@ -0,0 +1,52 @@
+#ifndef CHUNKEDFILE_H
+#define CHUNKEDFILE_H
+
+#include <QByteArray>
+#include <QVector>
+#include <QString>
+#include <QFile>
+#include <functional>
+#include "lasterror.h"
+
+#define CHUNKEDFILE_DATABASE_EXT "rdbz"
+
+// Compressed container made of independently compressed chunks (qCompress), so they are
+// compressed and decompressed in parallel and a byte range can be read without inflating the rest.
+//
+// Layout (little endian):
+//   Header  { magic "RDBZ", version, chunk size, reserved }
+//   char    chunks[]                                   (qCompress output)
+//   Index   { offset (u64), size, raw size }[count]
+//   Trailer { index offset (u64), count, magic "RDBZ" }
+class ChunkedFile : public LastError
+{
+    public:
+        typedef std::function<void(int, int)> ProgressCallback;
+
+    private:
+        struct Chunk { quint64 offset; quint32 size, rawsize; };
+
+    public:
+        ChunkedFile();
+        bool open(const QString& filepath);
+        bool compress(const QString& inpath, const QString& outpath, const ProgressCallback& cb = nullptr);
+        bool extract(const QString& outpath, const ProgressCallback& cb = nullptr);
+        QByteArray read(quint64 offset, quint64 size);
+        QByteArray chunk(int index);
+        quint64 size() const;
+        int count() const;
+
+    public:
+        static bool isChunked(const QString& filepath);
+
+    private:
+        QVector<QByteArray> chunks(int first, int last);
+
+    private:
+        QFile m_file;
+        QVector<Chunk> m_index;
+        quint64 m_size;
+        quint32 m_chunksize;
+};
+
+#endif // CHUNKEDFILE_H
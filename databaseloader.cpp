@@ -0,0 +1,47 @@
+#include "databaseloader.h"
+#include "chunkedfile.h"
+#include <redasm/database/database.h>
+#include <QTemporaryFile>
+
+DatabaseLoader::DatabaseLoader(const QString &tempdir): m_tempdir(tempdir) { }
+
+REDasm::Disassembler *DatabaseLoader::load(const QString &filepath)
+{
+    std::string filename, rdbpath = filepath.toStdString();
+    QTemporaryFile rawfile(QDir(m_tempdir).filePath(QString("redasm-XXXXXX.%1").arg(RDB_SIGNATURE_EXT)));
+    m_filename.clear();
+
+    if(ChunkedFile::isChunked(filepath)) // Inflated in parallel to a plain database first
+    {
+        ChunkedFile chunkedfile;
+
+        if(!rawfile.open())
+        {
+            this->fail("Cannot write " + rawfile.fileName() + ": " + rawfile.errorString());
+            return nullptr;
+        }
+
+        rawfile.close();
+
+        if(!chunkedfile.open(filepath) || !chunkedfile.extract(rawfile.fileName()))
+        {
+            this->fail(chunkedfile.lastError());
+            return nullptr;
+        }
+
+        rdbpath = rawfile.fileName().toStdString();
+    }
+
+    REDasm::Disassembler* disassembler = REDasm::Database::load(rdbpath, filename);
+
+    if(!disassembler)
+    {
+        this->fail(QString::fromStdString(REDasm::Database::lastError()));
+        return nullptr;
+    }
+
+    m_filename = QString::fromStdString(filename);
+    return disassembler;
+}
+
+const QString &DatabaseLoader::fileName() const { return m_filename; }
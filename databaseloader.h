@@ -0,0 +1,22 @@
+#ifndef DATABASELOADER_H
+#define DATABASELOADER_H
+
+#include <QString>
+#include <QDir>
+#include <redasm/disassembler/disassembler.h>
+#include "lasterror.h"
+
+// Loads plain and compressed (.rdbz) databases: compressed ones are inflated to a plain database
+// in 'tempdir' first, it's removed as soon as the library has deserialized it.
+class DatabaseLoader : public LastError
+{
+    public:
+        DatabaseLoader(const QString& tempdir = QDir::tempPath());
+        REDasm::Disassembler* load(const QString& filepath);
+        const QString& fileName() const;
+
+    private:
+        QString m_tempdir, m_filename; // Name of the disassembled file
+};
+
+#endif // DATABASELOADER_H
@@ -0,0 +1,161 @@
+#include "databasesaver.h"
+#include "chunkedfile.h"
+#include <redasm/database/database.h>
+#include <QtConcurrent>
+#include <QTemporaryFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QDir>
+
+#ifdef Q_OS_WIN
+    #include <windows.h>
+    #include <io.h>
+#else
+    #include <unistd.h>
+    #include <fcntl.h>
+    #include <cstdio>
+#endif
+
+static QHash<REDasm::DisassemblerAPI*, DatabaseSaver*> savers; // Saves in progress, GUI thread only
+
+DatabaseSaver::DatabaseSaver(QObject *parent) : QObject(parent), m_disassembler(nullptr)
+{
+    connect(&m_watcher, &QFutureWatcher<bool>::finished, this, &DatabaseSaver::onSaved);
+}
+
+DatabaseSaver::~DatabaseSaver()
+{
+    m_watcher.waitForFinished();
+    savers.remove(m_disassembler); // Queued edits die with the document
+}
+
+bool DatabaseSaver::save(REDasm::DisassemblerAPI *disassembler, const QString &rdbpath, const QString &filename)
+{
+    if(this->isSaving())
+        return this->fail("A save is already running");
+
+    if(disassembler->busy())
+        return this->fail("Cannot save while the disassembler is busy");
+
+    m_disassembler = disassembler;
+    savers[disassembler] = this;
+    m_watcher.setFuture(QtConcurrent::run([=]() -> bool { return this->write(rdbpath, filename); }));
+    return true;
+}
+
+bool DatabaseSaver::isSaving() const { return m_watcher.isRunning() || savers.contains(m_disassembler); }
+
+void DatabaseSaver::waitForFinished()
+{
+    m_watcher.waitForFinished();
+
+    if(savers.contains(m_disassembler)) // 'finished' is still queued: apply the edits now
+        this->onSaved();
+}
+
+void DatabaseSaver::edit(REDasm::DisassemblerAPI *disassembler, const DatabaseSaver::Edit &edit)
+{
+    DatabaseSaver* saver = savers.value(disassembler);
+
+    if(saver)
+        saver->m_edits.push_back(edit);
+    else
+        edit();
+}
+
+void DatabaseSaver::onSaved()
+{
+    if(!savers.contains(m_disassembler))
+        return;
+
+    savers.remove(m_disassembler);
+
+    QVector<Edit> edits;
+    edits.swap(m_edits);
+
+    for(const Edit& edit : edits) // In the order they were made
+        edit();
+
+    emit saved(m_watcher.result());
+}
+
+bool DatabaseSaver::write(const QString &rdbpath, const QString &filename)
+{
+    QFileInfo fi(rdbpath);
+    QTemporaryFile tempfile(fi.absoluteDir().filePath(fi.fileName() + ".XXXXXX")); // Same filesystem: the rename is atomic
+
+    if(!tempfile.open())
+        return this->fail("Cannot write " + rdbpath + ": " + tempfile.errorString());
+
+    QString temppath = tempfile.fileName();
+    tempfile.close(); // The name stays reserved until 'tempfile' goes out of scope
+
+    if(fi.suffix() == CHUNKEDFILE_DATABASE_EXT) // Serialized as usual, then compressed
+    {
+        QTemporaryFile rawfile(QDir::temp().filePath(QString("redasm-XXXXXX.%1").arg(RDB_SIGNATURE_EXT))); // Only the compressed file is renamed
+
+        if(!rawfile.open())
+            return this->fail("Cannot write " + rdbpath + ": " + rawfile.errorString());
+
+        rawfile.close();
+
+        if(!REDasm::Database::save(m_disassembler, rawfile.fileName().toStdString(), filename.toStdString()))
+            return this->fail(QString::fromStdString(REDasm::Database::lastError()));
+
+        ChunkedFile chunkedfile;
+
+        if(!chunkedfile.compress(rawfile.fileName(), temppath))
+            return this->fail(chunkedfile.lastError());
+    }
+    else if(!REDasm::Database::save(m_disassembler, temppath.toStdString(), filename.toStdString()))
+        return this->fail(QString::fromStdString(REDasm::Database::lastError()));
+
+    QFile file(temppath);
+
+    if(!file.open(QFile::ReadWrite))
+        return this->fail("Cannot write " + rdbpath + ": " + file.errorString());
+
+#ifdef Q_OS_WIN
+    FlushFileBuffers(reinterpret_cast<HANDLE>(_get_osfhandle(file.handle())));
+#else
+    fsync(file.handle()); // Data must be on disk before the rename replaces the old database
+#endif
+
+    file.close();
+
+    QFile::Permissions permissions = QFile::ReadOwner | QFile::WriteOwner | QFile::ReadGroup | QFile::ReadOther;
+
+    if(fi.exists()) // QTemporaryFile creates it owner-only
+        permissions = QFile::permissions(rdbpath);
+
+    if(!QFile::setPermissions(temppath, permissions))
+        return this->fail("Cannot set the permissions of " + rdbpath);
+
+    if(!DatabaseSaver::replaceFile(temppath, rdbpath))
+        return this->fail("Cannot replace " + rdbpath);
+
+    tempfile.setAutoRemove(false); // Renamed already
+    return true;
+}
+
+bool DatabaseSaver::replaceFile(const QString &from, const QString &to)
+{
+#ifdef Q_OS_WIN
+    return MoveFileExW(reinterpret_cast<LPCWSTR>(QDir::toNativeSeparators(from).utf16()),
+                       reinterpret_cast<LPCWSTR>(QDir::toNativeSeparators(to).utf16()),
+                       MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+    if(std::rename(QFile::encodeName(from).constData(), QFile::encodeName(to).constData()))
+        return false;
+
+    int fd = open(QFile::encodeName(QFileInfo(to).absolutePath()).constData(), O_RDONLY); // The rename is on disk when its directory is
+
+    if(fd != -1)
+    {
+        fsync(fd);
+        close(fd);
+    }
+
+    return true;
+#endif
+}
@@ -0,0 +1,48 @@
+#ifndef DATABASESAVER_H
+#define DATABASESAVER_H
+
+#include <QObject>
+#include <QFutureWatcher>
+#include <QVector>
+#include <functional>
+#include <redasm/disassembler/disassemblerapi.h>
+#include "lasterror.h"
+
+// Saves a database on a worker: the file is written next to the destination and renamed over it when complete,
+// so an interrupted save never leaves a truncated database behind.
+// User edits made meanwhile are queued and applied when the save ends: the file is a snapshot of the moment
+// the save started, and the document is never modified under the serializer.
+class DatabaseSaver : public QObject, public LastError
+{
+    Q_OBJECT
+
+    public:
+        typedef std::function<void()> Edit;
+
+    public:
+        explicit DatabaseSaver(QObject *parent = nullptr);
+        ~DatabaseSaver();
+        bool save(REDasm::DisassemblerAPI* disassembler, const QString& rdbpath, const QString& filename);
+        bool isSaving() const;
+        void waitForFinished();
+
+    public:
+        static void edit(REDasm::DisassemblerAPI* disassembler, const Edit& edit);
+
+    private slots:
+        void onSaved();
+
+    private:
+        bool write(const QString& rdbpath, const QString& filename);
+        static bool replaceFile(const QString& from, const QString& to);
+
+    signals:
+        void saved(bool ok);
+
+    private:
+        REDasm::DisassemblerAPI* m_disassembler;
+        QFutureWatcher<bool> m_watcher;
+        QVector<Edit> m_edits;
+};
+
+#endif // DATABASESAVER_H
@@ -0,0 +1,111 @@
+#include "createsignaturedialog.h"
+#include "ui_createsignaturedialog.h"
+#include <redasm/plugins/loader.h>
+#include <QtConcurrent>
+#include <QFileDialog>
+#include <QMessageBox>
+#include <QPushButton>
+
+CreateSignatureDialog::CreateSignatureDialog(REDasm::DisassemblerAPI *disassembler, const QVector<address_t> &selected, QWidget *parent) : QDialog(parent), ui(new Ui::CreateSignatureDialog), m_disassembler(disassembler), m_selected(selected), m_generator(disassembler)
+{
+    ui->setupUi(this);
+    ui->progressBar->setVisible(false);
+    ui->buttonBox->button(QDialogButtonBox::Ok)->setText("Generate");
+
+    m_named = SignatureGenerator::namedFunctions(disassembler);
+
+    ui->rbSelected->setText(QString("Selected functions (%1)").arg(m_selected.size()));
+    ui->rbSelected->setEnabled(!m_selected.empty());
+    ui->rbNamed->setText(QString("All named functions (%1)").arg(m_named.size()));
+
+    if(m_selected.empty())
+        ui->rbNamed->setChecked(true);
+    else
+        ui->rbSelected->setChecked(true);
+
+    connect(ui->leName, &QLineEdit::textChanged, this, [&](const QString& s) {
+        if(!s.isEmpty())
+            ui->leFile->setText(QString::fromStdString(REDasm::makeSignaturePath(s.toStdString())) + ".json");
+
+        this->validateEntries();
+    });
+
+    connect(ui->leFile, &QLineEdit::textChanged, this, &CreateSignatureDialog::validateEntries);
+    connect(ui->rbNamed, &QRadioButton::toggled, this, &CreateSignatureDialog::validateEntries);
+    connect(ui->pbBrowse, &QPushButton::clicked, this, &CreateSignatureDialog::browseFile);
+    connect(ui->buttonBox, &QDialogButtonBox::accepted, this, &CreateSignatureDialog::accept);
+    connect(ui->buttonBox, &QDialogButtonBox::rejected, this, &CreateSignatureDialog::reject);
+    connect(&m_watcher, &QFutureWatcher<bool>::finished, this, &CreateSignatureDialog::onGenerated);
+    this->validateEntries();
+}
+
+CreateSignatureDialog::~CreateSignatureDialog()
+{
+    m_generator.stop();
+    m_watcher.waitForFinished();
+    delete ui;
+}
+
+QString CreateSignatureDialog::signaturePath() const { return ui->leFile->text(); }
+
+void CreateSignatureDialog::accept()
+{
+    if(m_watcher.isRunning())
+        return;
+
+    QVector<address_t> functions = ui->rbNamed->isChecked() ? m_named : m_selected;
+    QString name = ui->leName->text(), sigpath = ui->leFile->text();
+
+    ui->progressBar->setRange(0, functions.size() + 1);
+    ui->progressBar->setValue(0);
+    ui->progressBar->setVisible(true);
+    ui->buttonBox->button(QDialogButtonBox::Ok)->setEnabled(false);
+
+    m_watcher.setFuture(QtConcurrent::run([=]() -> bool {
+        return m_generator.generate(functions, name, sigpath, [&](int value, int) {
+            QMetaObject::invokeMethod(ui->progressBar, "setValue", Qt::QueuedConnection, Q_ARG(int, value));
+        });
+    }));
+}
+
+void CreateSignatureDialog::reject()
+{
+    m_generator.stop(); // The file is left untouched
+    m_watcher.waitForFinished();
+    QDialog::reject();
+}
+
+void CreateSignatureDialog::browseFile()
+{
+    QString s = QFileDialog::getSaveFileName(this, "Save Signature As...",
+                                             ui->leFile->text().isEmpty() ? QString::fromStdString(REDasm::makeSignaturePath(std::string())) : ui->leFile->text(),
+                                             "REDasm Signature (*.json)");
+
+    if(!s.isEmpty())
+        ui->leFile->setText(s);
+}
+
+void CreateSignatureDialog::onGenerated()
+{
+    if(!this->isVisible()) // Stopped by reject()
+        return;
+
+    ui->progressBar->setVisible(false);
+    this->validateEntries();
+
+    if(m_watcher.isCanceled() || !m_watcher.result())
+    {
+        QMessageBox::warning(this, "Signature Error", m_generator.lastError());
+        return;
+    }
+
+    QMessageBox::information(this, "Signature", QString("%1 signature(s) written to %2").arg(m_generator.count()).arg(ui->leFile->text()));
+    QDialog::accept();
+}
+
+void CreateSignatureDialog::validateEntries()
+{
+    bool hasfunctions = ui->rbNamed->isChecked() ? !m_named.empty() : !m_selected.empty();
+    bool canaccept = !m_watcher.isRunning() && hasfunctions && !ui->leName->text().isEmpty() && !ui->leFile->text().isEmpty();
+    ui->buttonBox->button(QDialogButtonBox::Ok)->setEnabled(canaccept);
+}
@@ -0,0 +1,41 @@
+#ifndef CREATESIGNATUREDIALOG_H
+#define CREATESIGNATUREDIALOG_H
+
+#include <QFutureWatcher>
+#include <QDialog>
+#include "../../models/signatures/signaturegenerator.h"
+#include <redasm/disassembler/disassemblerapi.h>
+
+namespace Ui {
+class CreateSignatureDialog;
+}
+
+class CreateSignatureDialog : public QDialog
+{
+    Q_OBJECT
+
+    public:
+        explicit CreateSignatureDialog(REDasm::DisassemblerAPI* disassembler, const QVector<address_t>& selected, QWidget *parent = nullptr);
+        ~CreateSignatureDialog();
+        QString signaturePath() const;
+
+    public slots:
+        void accept() override;
+        void reject() override;
+
+    private slots:
+        void browseFile();
+        void onGenerated();
+
+    private:
+        void validateEntries();
+
+    private:
+        Ui::CreateSignatureDialog *ui;
+        REDasm::DisassemblerAPI* m_disassembler;
+        QVector<address_t> m_selected, m_named;
+        QFutureWatcher<bool> m_watcher;
+        SignatureGenerator m_generator;
+};
+
+#endif // CREATESIGNATUREDIALOG_H
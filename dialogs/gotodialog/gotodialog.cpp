@@ -34,14 +34,14 @@ void GotoDialog::validateEntry()
     {
         m_validaddress = false;
         ui->pbGoto->setEnabled(false);
-        m_gotomodel->setFilterFixedString(QString());
+        m_gotomodel->setFilter(QString());
         return;
     }
 
     m_address = s.toULongLong(&ok, 16);
     ui->pbGoto->setEnabled(ok);
     m_validaddress = ok;
-    m_gotomodel->setFilterFixedString(s);
+    m_gotomodel->setFilter(s);
 }
 
 void GotoDialog::onItemSelected(const QModelIndex &index)
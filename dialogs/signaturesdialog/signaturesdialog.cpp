@@ -1,14 +1,18 @@
 #include "signaturesdialog.h"
 #include "ui_signaturesdialog.h"
+#include "../createsignaturedialog/createsignaturedialog.h"
+#include <QtConcurrent>
 #include <QFileDialog>
 #include <QMessageBox>
 
-SignaturesDialog::SignaturesDialog(REDasm::DisassemblerAPI *disassembler, QWidget *parent) : QDialog(parent), ui(new Ui::SignaturesDialog), m_disassembler(disassembler)
+SignaturesDialog::SignaturesDialog(REDasm::DisassemblerAPI *disassembler, QWidget *parent) : QDialog(parent), ui(new Ui::SignaturesDialog), m_disassembler(disassembler), m_batch(disassembler)
 {
     ui->setupUi(this);
     ui->leFilter->setEnabled(false);
     ui->pbLoad->setEnabled(false);
+    ui->pbLoadAll->setEnabled(false);
     ui->splitter->setStretchFactor(1, 1);
+    ui->progressBar->setVisible(false);
 
     m_signaturefilesmodel = new SignatureFilesModel(disassembler, this);
     m_signaturesmodel = new SignaturesModel(this);
@@ -26,36 +30,162 @@ SignaturesDialog::SignaturesDialog(REDasm::DisassemblerAPI *disassembler, QWidge
     ui->tvSignatures->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
 
     connect(ui->tvFiles, &QTableView::clicked, this, &SignaturesDialog::readSignature);
+    connect(ui->tvFiles->selectionModel(), &QItemSelectionModel::selectionChanged, this, &SignaturesDialog::updateLoadButtons);
     connect(ui->pbLoad, &QPushButton::clicked, this, &SignaturesDialog::loadSignature);
+    connect(ui->pbLoadAll, &QPushButton::clicked, this, &SignaturesDialog::loadAllSignatures);
     connect(ui->pbBrowse, &QPushButton::clicked, this, &SignaturesDialog::browseSignatures);
+    connect(ui->pbCreate, &QPushButton::clicked, this, &SignaturesDialog::createSignature);
     connect(ui->leFilter, &QLineEdit::textChanged, m_filtermodel, &QSortFilterProxyModel::setFilterFixedString);
 
+    connect(m_signaturefilesmodel, &SignatureFilesModel::loadProgress, this, &SignaturesDialog::onLoadProgress);
+    connect(m_signaturefilesmodel, &SignatureFilesModel::signatureLoaded, this, &SignaturesDialog::onSignatureLoaded);
+    connect(m_signaturefilesmodel, &SignatureFilesModel::signatureFailed, this, &SignaturesDialog::onSignatureFailed);
+    connect(&m_applywatcher, &QFutureWatcher< QVector<SignatureBatch::Result> >::finished, this, &SignaturesDialog::onSignaturesApplied);
+    this->updateLoadButtons();
 }
 
-SignaturesDialog::~SignaturesDialog() { delete ui; }
+SignaturesDialog::~SignaturesDialog()
+{
+    m_batch.stop(); // The DB being applied is completed
+    m_applywatcher.waitForFinished();
+    delete ui;
+}
+
+void SignaturesDialog::loadSignature(bool) { this->applySignatures(ui->tvFiles->selectionModel()->selectedRows()); }
 
-void SignaturesDialog::loadSignature(bool)
+void SignaturesDialog::loadAllSignatures(bool)
 {
-    const std::string& sigpath = m_signaturefilesmodel->signaturePath(ui->tvFiles->currentIndex());
+    QModelIndexList indexes;
 
-    if(m_disassembler->loadSignature(sigpath))
+    for(int i = 0; i < m_signaturefilesmodel->rowCount(); i++)
+        indexes.push_back(m_signaturefilesmodel->index(i));
+
+    this->applySignatures(indexes);
+}
+
+void SignaturesDialog::readSignature(const QModelIndex &index)
+{
+    ui->leFilter->clear();
+    ui->leFilter->setEnabled(false);
+    m_signaturesmodel->setSignature(m_signaturefilesmodel->signature(index));
+
+    if(m_signaturefilesmodel->signature(index))
     {
-        m_signaturefilesmodel->mark(ui->tvFiles->currentIndex());
+        this->onSignatureLoaded(index.row());
+        return;
+    }
+
+    ui->progressBar->setRange(0, 0);
+    ui->progressBar->setVisible(true);
+    m_signaturefilesmodel->load(index);
+}
+
+void SignaturesDialog::onLoadProgress(int row, int value, int maximum)
+{
+    if(m_applywatcher.isRunning() || (row != ui->tvFiles->currentIndex().row())) // The bar shows the batch
         return;
+
+    ui->progressBar->setRange(0, maximum);
+    ui->progressBar->setValue(value);
+}
+
+void SignaturesDialog::onSignatureLoaded(int row)
+{
+    QModelIndex index = ui->tvFiles->currentIndex();
+
+    if(row != index.row()) // Another file has been selected meanwhile
+        return;
+
+    ui->progressBar->setVisible(m_applywatcher.isRunning());
+    ui->leFilter->setEnabled(true);
+    m_signaturesmodel->setSignature(m_signaturefilesmodel->signature(index));
+}
+
+void SignaturesDialog::onSignatureFailed(int row, const QString &error)
+{
+    if(row != ui->tvFiles->currentIndex().row())
+        return;
+
+    ui->progressBar->setVisible(m_applywatcher.isRunning());
+    QMessageBox::warning(this, "Load Error", error);
+}
+
+void SignaturesDialog::onSignaturesApplied()
+{
+    QVector<SignatureBatch::Result> results = m_applywatcher.result();
+    int hits = 0, failed = 0;
+
+    for(const SignatureBatch::Result& result : results)
+    {
+        hits += result.hits;
+
+        if(result.ok)
+            m_signaturefilesmodel->mark(m_signaturefilesmodel->index(m_applyrows[result.id]));
+        else
+            failed++;
     }
 
+    m_applyrows.clear();
+    ui->progressBar->setVisible(false);
+    this->updateLoadButtons();
+
+    if((results.size() == 1) && !failed) // Nothing worth a report
+        return;
+
     QMessageBox msgbox(this);
-    msgbox.setWindowTitle("Load Error");
-    msgbox.setText(QString("Error loading '%1'").arg(QFileInfo(QString::fromStdString(sigpath)).fileName()));
+    msgbox.setWindowTitle("Signatures");
+    msgbox.setText(QString("%1 signature(s) applied, %2 function(s) found").arg(results.size() - failed).arg(hits));
+    msgbox.setDetailedText(SignatureBatch::report(results));
+    msgbox.setIcon(failed ? QMessageBox::Warning : QMessageBox::Information);
     msgbox.setStandardButtons(QMessageBox::Ok);
+    msgbox.exec();
 }
 
-void SignaturesDialog::readSignature(const QModelIndex &index)
+void SignaturesDialog::applySignatures(const QModelIndexList &indexes)
 {
-    ui->leFilter->clear();
-    ui->leFilter->setEnabled(true);
-    ui->pbLoad->setEnabled(!m_signaturefilesmodel->isLoaded(index));
-    m_signaturesmodel->setSignature(m_signaturefilesmodel->load(index));
+    if(m_applywatcher.isRunning())
+        return;
+
+    QVector<SignatureBatch::Signature> signatures;
+
+    for(const QModelIndex& index : indexes)
+    {
+        if(m_signaturefilesmodel->isLoaded(index))
+            continue;
+
+        QString sigid = QString::fromStdString(m_signaturefilesmodel->signatureId(index));
+        signatures.push_back({ sigid, QString::fromStdString(m_signaturefilesmodel->signaturePath(index)) });
+        m_applyrows[sigid] = index.row();
+    }
+
+    if(signatures.empty())
+        return;
+
+    ui->progressBar->setRange(0, signatures.size());
+    ui->progressBar->setValue(0);
+    ui->progressBar->setVisible(true);
+    ui->pbLoad->setEnabled(false);
+    ui->pbLoadAll->setEnabled(false);
+
+    m_applywatcher.setFuture(QtConcurrent::run([=]() -> QVector<SignatureBatch::Result> {
+        return m_batch.apply(signatures, [&](int value, int) {
+            QMetaObject::invokeMethod(ui->progressBar, "setValue", Qt::QueuedConnection, Q_ARG(int, value));
+        });
+    }));
+}
+
+void SignaturesDialog::updateLoadButtons()
+{
+    bool canload = false, canloadall = false;
+
+    for(const QModelIndex& index : ui->tvFiles->selectionModel()->selectedRows())
+        canload |= !m_signaturefilesmodel->isLoaded(index);
+
+    for(int i = 0; !canloadall && (i < m_signaturefilesmodel->rowCount()); i++)
+        canloadall = !m_signaturefilesmodel->isLoaded(m_signaturefilesmodel->index(i));
+
+    ui->pbLoad->setEnabled(!m_applywatcher.isRunning() && canload);
+    ui->pbLoadAll->setEnabled(!m_applywatcher.isRunning() && canloadall);
 }
 
 void SignaturesDialog::browseSignatures()
@@ -64,9 +194,20 @@ void SignaturesDialog::browseSignatures()
                                              QString::fromStdString(REDasm::makeSignaturePath(std::string())),
                                              "REDasm Signature (*.json)");
 
-    if(s.isEmpty())
-        return;
+    if(!s.isEmpty())
+        this->addSignature(s);
+}
+
+void SignaturesDialog::createSignature()
+{
+    CreateSignatureDialog dlgcreatesignature(m_disassembler, QVector<address_t>(), this);
+
+    if(dlgcreatesignature.exec() == CreateSignatureDialog::Accepted)
+        this->addSignature(dlgcreatesignature.signaturePath());
+}
 
+void SignaturesDialog::addSignature(const QString &s)
+{
     std::string sigid = QFileInfo(s).baseName().toStdString();
 
     if(m_signaturefilesmodel->contains(sigid))
@@ -2,9 +2,11 @@
 #define SIGNATURESDIALOG_H
 
 #include <QSortFilterProxyModel>
+#include <QFutureWatcher>
 #include <QDialog>
 #include "../models/signatures/signaturefilesmodel.h"
 #include "../models/signatures/signaturesmodel.h"
+#include "../models/signatures/signaturebatch.h"
 #include <redasm/disassembler/disassemblerapi.h>
 
 namespace Ui {
@@ -21,8 +23,19 @@ class SignaturesDialog : public QDialog
 
     private slots:
         void loadSignature(bool);
+        void loadAllSignatures(bool);
         void readSignature(const QModelIndex& index);
         void browseSignatures();
+        void createSignature();
+        void onLoadProgress(int row, int value, int maximum);
+        void onSignatureLoaded(int row);
+        void onSignatureFailed(int row, const QString& error);
+        void onSignaturesApplied();
+
+    private:
+        void applySignatures(const QModelIndexList& indexes);
+        void addSignature(const QString& s);
+        void updateLoadButtons();
 
     private:
         Ui::SignaturesDialog *ui;
@@ -30,6 +43,9 @@ class SignaturesDialog : public QDialog
         SignatureFilesModel* m_signaturefilesmodel;
         SignaturesModel* m_signaturesmodel;
         QSortFilterProxyModel* m_filtermodel;
+        QFutureWatcher< QVector<SignatureBatch::Result> > m_applywatcher;
+        QHash<QString, int> m_applyrows;
+        SignatureBatch m_batch;
 };
 
 #endif // SIGNATURESDIALOG_H
@@ -1,10 +1,13 @@
 #include "disassembleractions.h"
+#include "databasesaver.h"
+#include "editjournal.h"
 #include <redasm/disassembler/listing/listingdocument.h>
 #include <redasm/plugins/assembler/assembler.h>
 #include <QApplication>
 #include <QInputDialog>
 #include <QMessageBox>
 #include <QClipboard>
+#include <QMetaMethod>
 
 DisassemblerActions::DisassemblerActions(QWidget *parent): QObject(parent), m_renderer(nullptr) { this->createActions(); }
 DisassemblerActions::DisassemblerActions(REDasm::ListingRenderer* renderer, QWidget *parent) : QObject(parent), m_renderer(renderer) { this->createActions(); }
@@ -19,6 +22,7 @@ void DisassemblerActions::adjustActions()
 
     auto lock = REDasm::s_lock_safe_ptr(m_renderer->document());
     const REDasm::ListingItem* item = lock->currentItem();
+    m_actions[DisassemblerActions::ExportGraph]->setVisible(this->isSignalConnected(QMetaMethod::fromSignal(&DisassemblerActions::exportGraphRequested)));
 
     if(!item)
         return;
@@ -97,6 +101,7 @@ void DisassemblerActions::createActions()
     m_contextmenu->addSeparator();
     m_actions[DisassemblerActions::Copy] = m_contextmenu->addAction("Copy", this, &DisassemblerActions::copy, QKeySequence(QKeySequence::Copy));
     m_actions[DisassemblerActions::ItemInformation] = m_contextmenu->addAction("Item Information", this, &DisassemblerActions::itemInformationRequested);
+    m_actions[DisassemblerActions::ExportGraph] = m_contextmenu->addAction("Export Graph...", this, &DisassemblerActions::exportGraphRequested);
 
     if(pw)
     {
@@ -134,7 +139,12 @@ void DisassemblerActions::renameSymbolUnderCursor()
         return;
     }
 
-    m_renderer->document()->rename(symbol->address, res.toStdString());
+    REDasm::ListingDocument& document = m_renderer->document();
+    address_t address = symbol->address;
+    std::string name = res.toStdString();
+
+    EditJournal::record(m_renderer->disassembler(), { EditJournal::Rename, address, res });
+    DatabaseSaver::edit(m_renderer->disassembler(), [&document, address, name]() { document->rename(address, name); });
 }
 
 bool DisassemblerActions::followUnderCursor()
@@ -240,7 +250,11 @@ void DisassemblerActions::addComment()
     if(!ok)
         return;
 
-    m_renderer->document()->comment(currentitem, res.toStdString());
+    REDasm::ListingDocument& document = m_renderer->document();
+    std::string comment = res.toStdString();
+
+    EditJournal::record(m_renderer->disassembler(), { EditJournal::Comment, currentitem->address, res });
+    DatabaseSaver::edit(m_renderer->disassembler(), [&document, currentitem, comment]() { document->comment(currentitem, comment); });
 }
 
 void DisassemblerActions::goForward() { m_renderer->document()->cursor()->goForward(); }
@@ -14,7 +14,7 @@ class DisassemblerActions : public QObject
         enum { Rename = 0, XRefs, Follow, FollowPointerHexDump,
                CallGraph, Goto, HexDump, HexDumpFunction, Comment,
                Back, Forward, Copy,
-               ItemInformation };
+               ItemInformation, ExportGraph };
 
     public:
         explicit DisassemblerActions(QWidget *parent = nullptr);
@@ -50,6 +50,7 @@ class DisassemblerActions : public QObject
         void referencesRequested(address_t address);
         void callGraphRequested(address_t address);
         void itemInformationRequested();
+        void exportGraphRequested();
         void gotoDialogRequested();
         void switchToHexDump();
 
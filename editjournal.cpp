@@ -0,0 +1,254 @@
+#include "editjournal.h"
+#include <redasm/disassembler/listing/listingdocument.h>
+#include <QDataStream>
+#include <QSaveFile>
+#include <QHash>
+
+#ifdef Q_OS_WIN
+    #include <windows.h>
+    #include <io.h>
+#else
+    #include <unistd.h>
+#endif
+
+#define JOURNAL_MAGIC         "RDJL"
+#define JOURNAL_VERSION       2
+#define JOURNAL_EXT           ".journal"
+#define JOURNAL_RECORD_HEADER 6    // Payload size + checksum
+#define JOURNAL_EDIT_HEADER   9    // Type + address
+#define JOURNAL_SYNC_INTERVAL 1000 // ms, edits synced together
+
+static QHash<REDasm::DisassemblerAPI*, EditJournal*> journals; // GUI thread only
+
+EditJournal::EditJournal(REDasm::DisassemblerAPI *disassembler, QObject *parent) : QObject(parent), m_disassembler(disassembler)
+{
+    m_synctimer = new QTimer(this);
+    m_synctimer->setSingleShot(true);
+    m_synctimer->setInterval(JOURNAL_SYNC_INTERVAL);
+    connect(m_synctimer, &QTimer::timeout, this, &EditJournal::sync);
+
+    journals[disassembler] = this;
+}
+
+EditJournal::~EditJournal()
+{
+    journals.remove(m_disassembler);
+    this->sync();
+}
+
+bool EditJournal::open(const QString &journalpath, const QString &filename, const QByteArray &hash)
+{
+    this->sync();
+    m_file.close();
+    m_file.setFileName(journalpath);
+    m_filename = filename;
+    m_hash = hash;
+    m_pending.clear();
+
+    if(!m_file.open(QFile::ReadWrite))
+        return this->fail("Cannot open " + journalpath + ": " + m_file.errorString());
+
+    if(!this->readEdits(&m_pending)) // Missing, damaged or written for another file: start over
+    {
+        m_pending.clear();
+        m_file.resize(0);
+
+        if((m_file.write(this->header()) == -1) || !m_file.flush())
+            return this->fail("Cannot write " + journalpath + ": " + m_file.errorString());
+    }
+
+    m_file.seek(m_file.size());
+    return true;
+}
+
+bool EditJournal::compact(qint64 mark, const QByteArray &hash)
+{
+    if(!m_file.isOpen())
+        return false;
+
+    this->sync();
+    m_hash = hash; // The tail is replayed on top of the saved database
+
+    QByteArray tail; // Edits made while the database was written
+
+    if(m_file.seek(mark))
+        tail = m_file.readAll();
+
+    QString journalpath = m_file.fileName();
+    QSaveFile file(journalpath);
+
+    if(!file.open(QFile::WriteOnly))
+        return this->fail("Cannot write " + journalpath + ": " + file.errorString());
+
+    file.write(this->header());
+    file.write(tail);
+
+    if(!file.commit())
+        return this->fail("Cannot write " + journalpath + ": " + file.errorString());
+
+    m_file.close();
+    m_file.setFileName(journalpath);
+
+    if(!m_file.open(QFile::ReadWrite))
+        return this->fail("Cannot open " + journalpath + ": " + m_file.errorString());
+
+    m_file.seek(m_file.size());
+    return true;
+}
+
+bool EditJournal::discard()
+{
+    if(!m_file.isOpen())
+        return false;
+
+    m_pending.clear();
+
+    if(!m_file.resize(this->header().size()))
+        return this->fail("Cannot write " + m_file.fileName() + ": " + m_file.errorString());
+
+    m_file.seek(m_file.size());
+    this->sync();
+    return true;
+}
+
+bool EditJournal::hasEdits() const { return m_file.isOpen() && (m_file.size() > this->header().size()); }
+qint64 EditJournal::mark() const { return m_file.isOpen() ? m_file.size() : 0; }
+
+int EditJournal::replay()
+{
+    if(m_pending.empty() || m_disassembler->busy())
+        return 0;
+
+    REDasm::ListingDocument& document = m_disassembler->document();
+
+    for(const Edit& edit : m_pending)
+    {
+        if(edit.type == EditJournal::Rename)
+            document->rename(edit.address, edit.text.toStdString());
+        else if(edit.type == EditJournal::Comment)
+        {
+            auto it = document->instructionItem(edit.address);
+
+            if(it != document->end())
+                document->comment(it->get(), edit.text.toStdString());
+        }
+    }
+
+    int count = m_pending.size();
+    m_pending.clear();
+    return count;
+}
+
+
+void EditJournal::record(REDasm::DisassemblerAPI *disassembler, const EditJournal::Edit &edit)
+{
+    EditJournal* journal = journals.value(disassembler);
+
+    if(journal && !journal->append(edit))
+        REDasm::log(journal->lastError().toStdString());
+}
+
+QString EditJournal::journalPath(const QString &rdbpath) { return rdbpath + JOURNAL_EXT; }
+
+void EditJournal::sync()
+{
+    m_synctimer->stop();
+
+    if(!m_file.isOpen() || !m_file.flush())
+        return;
+
+#ifdef Q_OS_WIN
+    FlushFileBuffers(reinterpret_cast<HANDLE>(_get_osfhandle(m_file.handle())));
+#else
+    fsync(m_file.handle());
+#endif
+}
+
+bool EditJournal::append(const EditJournal::Edit &edit)
+{
+    if(!m_file.isOpen())
+        return false;
+
+    QByteArray payload, record;
+
+    {
+        QDataStream stream(&payload, QIODevice::WriteOnly);
+        stream.setByteOrder(QDataStream::LittleEndian);
+        stream << static_cast<quint8>(edit.type) << static_cast<quint64>(edit.address);
+    }
+
+    payload += edit.text.toUtf8();
+
+    {
+        QDataStream stream(&record, QIODevice::WriteOnly);
+        stream.setByteOrder(QDataStream::LittleEndian);
+        stream << static_cast<quint32>(payload.size()) << qChecksum(payload.constData(), static_cast<uint>(payload.size()));
+    }
+
+    record += payload;
+
+    if((m_file.write(record) != record.size()) || !m_file.flush()) // In the OS' hands, synced later
+        return this->fail("Cannot write " + m_file.fileName() + ": " + m_file.errorString());
+
+    if(!m_synctimer->isActive())
+        m_synctimer->start();
+
+    return true;
+}
+
+bool EditJournal::readEdits(QVector<Edit> *edits)
+{
+    QByteArray data = m_file.readAll();
+    QByteArray header = this->header();
+
+    if(!data.startsWith(header))
+        return false;
+
+    int pos = header.size();
+
+    while((pos + JOURNAL_RECORD_HEADER) <= data.size())
+    {
+        QDataStream stream(data.mid(pos, JOURNAL_RECORD_HEADER));
+        stream.setByteOrder(QDataStream::LittleEndian);
+
+        quint32 size = 0;
+        quint16 checksum = 0;
+        stream >> size >> checksum;
+
+        if((size < JOURNAL_EDIT_HEADER) || (size > static_cast<quint32>(data.size() - pos - JOURNAL_RECORD_HEADER)))
+            break;
+
+        QByteArray payload = data.mid(pos + JOURNAL_RECORD_HEADER, static_cast<int>(size));
+
+        if(qChecksum(payload.constData(), static_cast<uint>(payload.size())) != checksum)
+            break;
+
+        QDataStream payloadstream(payload);
+        payloadstream.setByteOrder(QDataStream::LittleEndian);
+
+        quint8 type = 0;
+        quint64 address = 0;
+        payloadstream >> type >> address;
+
+        edits->push_back({ static_cast<EditType>(type), static_cast<address_t>(address), QString::fromUtf8(payload.mid(JOURNAL_EDIT_HEADER)) });
+        pos += JOURNAL_RECORD_HEADER + static_cast<int>(size);
+    }
+
+    if(pos < data.size()) // Torn or damaged tail
+        m_file.resize(pos);
+
+    return true;
+}
+
+QByteArray EditJournal::header() const
+{
+    QByteArray header, filename = m_filename.toUtf8();
+    QDataStream stream(&header, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.writeRawData(JOURNAL_MAGIC, 4);
+    stream << static_cast<quint32>(JOURNAL_VERSION) << static_cast<quint32>(filename.size());
+    stream.writeRawData(filename.constData(), filename.size());
+    stream << static_cast<quint32>(m_hash.size());
+    stream.writeRawData(m_hash.constData(), m_hash.size());
+    return header;
+}
@@ -0,0 +1,59 @@
+#ifndef EDITJOURNAL_H
+#define EDITJOURNAL_H
+
+#include <QObject>
+#include <QVector>
+#include <QTimer>
+#include <QFile>
+#include <redasm/disassembler/disassemblerapi.h>
+#include "lasterror.h"
+
+// Append-only log of the user's edits, kept next to the database until the next save.
+// The header carries the hash of the file the edits were made on (the binary or the database it was loaded from),
+// edits are replayed only if the same file is opened again.
+// Records are flushed as they are made and synced to disk in batches; a torn record at the end
+// (crash while writing) is dropped when the journal is opened again.
+//
+// Layout (little endian):
+//   Header { magic "RDJL", version, filename length, filename (UTF-8), hash length, input hash }
+//   Record { payload size, payload checksum, payload { type, address, text (UTF-8) } }
+class EditJournal : public QObject, public LastError
+{
+    Q_OBJECT
+
+    public:
+        enum EditType: quint8 { Rename = 1, Comment };
+        struct Edit { EditType type; address_t address; QString text; };
+
+    public:
+        explicit EditJournal(REDasm::DisassemblerAPI* disassembler, QObject *parent = nullptr);
+        ~EditJournal();
+        bool open(const QString& journalpath, const QString& filename, const QByteArray& hash);
+        bool compact(qint64 mark, const QByteArray& hash);
+        bool discard();
+        bool hasEdits() const;
+        qint64 mark() const;
+        int replay();
+
+    public:
+        static void record(REDasm::DisassemblerAPI* disassembler, const Edit& edit);
+        static QString journalPath(const QString& rdbpath);
+
+    private slots:
+        void sync();
+
+    private:
+        bool append(const Edit& edit);
+        bool readEdits(QVector<Edit>* edits);
+        QByteArray header() const;
+
+    private:
+        REDasm::DisassemblerAPI* m_disassembler;
+        QVector<Edit> m_pending; // Read at open, not applied yet
+        QTimer* m_synctimer;
+        QString m_filename;
+        QByteArray m_hash;
+        QFile m_file;
+};
+
+#endif // EDITJOURNAL_H
@@ -0,0 +1,19 @@
+#ifndef LASTERROR_H
+#define LASTERROR_H
+
+#include <QString>
+
+// Error reporting of the classes that return 'false' on failure
+class LastError
+{
+    public:
+        const QString& lastError() const { return m_lasterror; }
+
+    protected:
+        bool fail(const QString& error) { m_lasterror = error; return false; }
+
+    private:
+        QString m_lasterror;
+};
+
+#endif // LASTERROR_H
@@ -3,6 +3,7 @@
 #include <QApplication>
 #include <QStyleFactory>
 #include "redasmsettings.h"
+#include "batchexport.h"
 
 #ifdef QT_DEBUG
     #include "unittest/unittest.h"
@@ -13,6 +14,16 @@ int main(int argc, char *argv[])
 #ifdef QT_DEBUG
     if((argc == 2) && !std::strcmp(argv[1], "--testmode"))
         return UnitTest::run();
+
+    if((argc > 2) && !std::strcmp(argv[1], "--benchmark-db"))
+    {
+        QStringList rdbpaths;
+
+        for(int i = 2; i < argc; i++)
+            rdbpaths.push_back(QString::fromLocal8Bit(argv[i]));
+
+        return UnitTest::benchmarkDatabases(rdbpaths);
+    }
 #endif // QT_DEBUG
 
     qRegisterMetaType<u64>("u64");
@@ -26,6 +37,10 @@ int main(int argc, char *argv[])
 
     REDasmSettings::setDefaultFormat(REDasmSettings::IniFormat);
     ThemeProvider::applyTheme();
+
+    if(BatchExport::isRequested(a.arguments()))
+        return BatchExport::run(a.arguments());
+
     MainWindow w;
     w.show();
     return a.exec();
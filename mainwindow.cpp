@@ -7,7 +7,12 @@
 #include "ui/redasmui.h"
 #include "redasmsettings.h"
 #include "themeprovider.h"
+#include "databaseloader.h"
+#include "chunkedfile.h"
+#include "mappedbuffer.h"
+#include "models/signatures/signaturecache.h"
 #include <redasm/database/database.h>
+#include <QtConcurrent>
 #include <QtWidgets>
 #include <QtCore>
 #include <QtGui>
@@ -48,6 +53,18 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWi
     m_pbstatus->setText(QString::fromWCharArray(L"\u25cf"));
     m_pbstatus->setVisible(false);
 
+    m_pbworking = new QProgressBar(this);
+    m_pbworking->setRange(0, 0); // The (de)serializer doesn't report its progress
+    m_pbworking->setTextVisible(false);
+    m_pbworking->setFixedWidth(ui->statusBar->height() * 4);
+    m_pbworking->setFixedHeight(ui->statusBar->height() * 0.5);
+    m_pbworking->setVisible(false);
+
+    m_saver = new DatabaseSaver(this);
+    m_journal = nullptr;
+    m_journalmark = 0;
+    m_loaddropped = false;
+
     m_pbproblems = new QPushButton(this);
     m_pbproblems->setFlat(true);
     m_pbproblems->setFixedHeight(ui->statusBar->height() * 0.8);
@@ -55,6 +72,7 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWi
 
     ui->statusBar->addPermanentWidget(m_lblstatus, 70);
     ui->statusBar->addPermanentWidget(m_lblprogress, 30);
+    ui->statusBar->addPermanentWidget(m_pbworking);
     ui->statusBar->addPermanentWidget(m_pbproblems);
     ui->statusBar->addPermanentWidget(m_pbstatus);
 
@@ -83,11 +101,22 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWi
 
     connect(m_pbstatus, &QPushButton::clicked, this, &MainWindow::changeDisassemblerStatus);
     connect(m_pbproblems, &QPushButton::clicked, this, &MainWindow::showProblems);
+    connect(m_saver, &DatabaseSaver::saved, this, &MainWindow::onDatabaseSaved);
+    connect(&m_loadwatcher, &QFutureWatcher<LoadedDatabase>::finished, this, &MainWindow::onDatabaseLoaded);
 
     qApp->installEventFilter(this);
 }
 
-MainWindow::~MainWindow() { delete ui; }
+MainWindow::~MainWindow()
+{
+    if(m_loaddropped) // Nobody will receive it anymore
+    {
+        m_loadwatcher.waitForFinished();
+        delete m_loadwatcher.result().disassembler;
+    }
+
+    delete ui;
+}
 
 void MainWindow::closeEvent(QCloseEvent *e)
 {
@@ -178,16 +207,12 @@ void MainWindow::onSaveClicked()
     if(!currdv)
         return;
 
-    std::string rdbfile = QString("%1.%2").arg(m_fileinfo.baseName(), RDB_SIGNATURE_EXT).toStdString();
-    REDasm::log("Saving Database " + REDasm::quoted(rdbfile));
-
-    if(!REDasm::Database::save(currdv->disassembler(), rdbfile, m_fileinfo.fileName().toStdString()))
-        REDasm::log(REDasm::Database::lastError());
+    this->saveDatabase(currdv->disassembler(), this->databasePath());
 }
 
 void MainWindow::onSaveAsClicked() // TODO: Handle multiple outputs
 {
-    QString s = QFileDialog::getSaveFileName(this, "Save As...", m_fileinfo.fileName(), "REDasm Database (*.rdb)");
+    QString s = QFileDialog::getSaveFileName(this, "Save As...", m_fileinfo.fileName(), "REDasm Database (*.rdb);;Compressed REDasm Database (*.rdbz)");
 
     if(s.isEmpty())
         return;
@@ -197,8 +222,23 @@ void MainWindow::onSaveAsClicked() // TODO: Handle multiple outputs
     if(!currdv)
         return;
 
-    if(!REDasm::Database::save(currdv->disassembler(), s.toStdString(), m_fileinfo.fileName().toStdString()))
-        REDasm::log(REDasm::Database::lastError());
+    this->saveDatabase(currdv->disassembler(), s);
+}
+
+void MainWindow::onDatabaseSaved(bool ok)
+{
+    m_pbworking->setVisible(false);
+    m_lblstatus->clear();
+
+    if(ok)
+        REDasm::log("Database saved");
+    else
+        REDasm::log(m_saver->lastError().toStdString());
+
+    if(ok && m_journal && (m_savepath == this->databasePath()) && !m_journal->compact(m_journalmark, SignatureCache::fileHash(m_savepath))) // Saved edits leave the journal
+        REDasm::log(m_journal->lastError().toStdString());
+
+    this->checkDisassemblerStatus();
 }
 
 void MainWindow::onRecentFileClicked()
@@ -282,29 +322,75 @@ void MainWindow::loadRecents()
     }
 }
 
-bool MainWindow::loadDatabase(const QString &filepath)
+void MainWindow::loadDatabase(const QString &filepath)
 {
-    std::string filename;
-    REDasm::Disassembler* disassembler = REDasm::Database::load(filepath.toStdString(), filename);
+    m_loadpath = filepath;
+    m_lblstatus->setText("Loading " + QFileInfo(filepath).fileName() + "...");
+    m_pbworking->setVisible(true);
+    ui->action_Open->setEnabled(false);
+    ui->action_Recent_Files->setEnabled(false);
+
+    m_loadwatcher.setFuture(QtConcurrent::run([=]() -> LoadedDatabase {
+        DatabaseLoader loader;
+        LoadedDatabase loaded = { loader.load(filepath), QString(), QString() };
+        loaded.filename = loader.fileName();
+        loaded.error = loader.lastError();
+        return loaded;
+    }));
+}
 
-    if(!disassembler)
+void MainWindow::onDatabaseLoaded()
+{
+    if(m_loaddropped) // Closed while deserializing, never shown
     {
-        if(m_fileinfo.suffix() == RDB_SIGNATURE_EXT)
-            REDasm::log(REDasm::Database::lastError());
+        delete m_loadwatcher.result().disassembler;
+        m_loaddropped = false;
+
+        QString queuedpath;
+        queuedpath.swap(m_queuedpath);
+
+        if(!queuedpath.isEmpty())
+            this->load(queuedpath);
 
-        return false;
+        return;
     }
 
-    REDasm::log("Selected loader " + REDasm::quoted(disassembler->loader()->name()) + " with " +
-                                     REDasm::quoted(disassembler->assembler()->name()) + " instruction set");
+    QString filepath = m_loadpath;
+    LoadedDatabase loaded = m_loadwatcher.result();
+    m_loadpath.clear();
+    m_lblstatus->clear();
+    m_pbworking->setVisible(false);
+    ui->action_Open->setEnabled(true);
+    ui->action_Recent_Files->setEnabled(!m_recents.empty());
 
-    m_fileinfo = QFileInfo(QString::fromStdString(filename));
-    this->showDisassemblerView(disassembler, true);
-    return true;
+    if(!loaded.disassembler)
+    {
+        if((m_fileinfo.suffix() == RDB_SIGNATURE_EXT) || (m_fileinfo.suffix() == CHUNKEDFILE_DATABASE_EXT))
+            REDasm::log(loaded.error.toStdString());
+        else
+            this->loadBinary(filepath); // Not a database
+
+        return;
+    }
+
+    REDasm::log("Selected loader " + REDasm::quoted(loaded.disassembler->loader()->name()) + " with " +
+                                     REDasm::quoted(loaded.disassembler->assembler()->name()) + " instruction set");
+
+    m_fileinfo = QFileInfo(loaded.filename);
+    this->showDisassemblerView(loaded.disassembler, true);
 }
 
 void MainWindow::load(const QString& filepath)
 {
+    if(!m_loadpath.isEmpty())
+        return;
+
+    if(m_loaddropped) // The watcher is still busy with the dropped load
+    {
+        m_queuedpath = filepath;
+        return;
+    }
+
     this->closeFile();
 
     m_fileinfo = QFileInfo(filepath);
@@ -313,11 +399,12 @@ void MainWindow::load(const QString& filepath)
     REDasmSettings settings;
     settings.updateRecentFiles(filepath);
     this->loadRecents();
+    this->loadDatabase(filepath); // Falls back to loadBinary()
+}
 
-    if(this->loadDatabase(filepath))
-        return;
-
-    REDasm::MemoryBuffer* buffer = REDasm::MemoryBuffer::fromFile(filepath.toStdString()); // TODO: Deallocate in case of user-cancel?
+void MainWindow::loadBinary(const QString &filepath)
+{
+    REDasm::AbstractBuffer* buffer = MappedBuffer::fromFile(filepath); // TODO: Deallocate in case of user-cancel?
 
     if(buffer && !buffer->empty())
     {
@@ -326,6 +413,26 @@ void MainWindow::load(const QString& filepath)
     }
 }
 
+void MainWindow::saveDatabase(REDasm::DisassemblerAPI *disassembler, const QString &rdbpath)
+{
+    REDasm::log("Saving Database " + REDasm::quoted(rdbpath.toStdString()));
+
+    if(!m_saver->save(disassembler, rdbpath, m_fileinfo.fileName()))
+    {
+        REDasm::log(m_saver->lastError().toStdString());
+        return;
+    }
+
+    m_savepath = QFileInfo(rdbpath).absoluteFilePath();
+    m_journalmark = m_journal ? m_journal->mark() : 0; // Edits made from now on aren't in the file
+
+    m_lblstatus->setText("Saving " + QFileInfo(rdbpath).fileName() + "...");
+    m_pbworking->setVisible(true);
+    this->setStandardActionsEnabled(false);
+}
+
+QString MainWindow::databasePath() const { return QDir::current().absoluteFilePath(QString("%1.%2").arg(m_fileinfo.baseName(), RDB_SIGNATURE_EXT)); }
+
 void MainWindow::checkCommandLine()
 {
     QStringList args = qApp->arguments();
@@ -374,6 +481,12 @@ void MainWindow::showDisassemblerView(REDasm::Disassembler *disassembler, bool f
     dv->bindDisassembler(disassembler, fromdatabase); // Take ownership
     ui->stackView->addWidget(dv);
 
+    delete m_journal;
+    m_journal = new EditJournal(disassembler, this); // Replayed as soon as the disassembler is idle
+
+    if(!m_journal->open(EditJournal::journalPath(this->databasePath()), m_fileinfo.fileName(), SignatureCache::fileHash(m_fileinfo.absoluteFilePath())))
+        REDasm::log(m_journal->lastError().toStdString());
+
     this->setViewWidgetsVisible(true);
     this->checkDisassemblerStatus();
 }
@@ -397,13 +510,43 @@ bool MainWindow::canClose()
     return true;
 }
 
+bool MainWindow::keepEdits()
+{
+    QMessageBox msgbox(this);
+    msgbox.setWindowTitle("Closing");
+    msgbox.setText("There are unsaved edits.");
+    msgbox.setInformativeText("Keep them to restore them the next time " + m_fileinfo.fileName() + " is opened?");
+    QPushButton* keepbutton = msgbox.addButton("Keep", QMessageBox::AcceptRole);
+    msgbox.addButton(QMessageBox::Discard);
+    msgbox.setDefaultButton(keepbutton);
+    msgbox.exec();
+
+    return msgbox.clickedButton() == keepbutton;
+}
+
 void MainWindow::closeFile()
 {
     REDasm::DisassemblerAPI* disassembler = this->currentDisassembler();
 
-    // TODO: messageBox for confirmation?
+    if(!m_loadpath.isEmpty()) // Still deserializing: onDatabaseLoaded() deletes it
+    {
+        m_loaddropped = true;
+        m_loadpath.clear();
+        m_pbworking->setVisible(false);
+        ui->action_Open->setEnabled(true);
+        ui->action_Recent_Files->setEnabled(!m_recents.empty());
+    }
+
     if(disassembler)
     {
+        m_saver->waitForFinished(); // The serializer is still reading it
+
+        if(m_journal && m_journal->hasEdits() && !this->keepEdits() && !m_journal->discard())
+            REDasm::log(m_journal->lastError().toStdString());
+
+        delete m_journal;
+        m_journal = nullptr;
+
         disassembler->busyChanged.disconnect();
         disassembler->stop();
     }
@@ -520,7 +663,13 @@ void MainWindow::checkDisassemblerStatus()
     m_pbproblems->setText(QString::number(REDasm::Context::problemsCount()) + " problem(s)");
     m_pbproblems->setVisible(!disassembler->busy() && REDasm::Context::hasProblems());
 
-    this->setStandardActionsEnabled(!disassembler->busy());
+    this->setStandardActionsEnabled(!disassembler->busy() && !m_saver->isSaving());
+
+    int replayed = (m_journal && !disassembler->busy()) ? m_journal->replay() : 0;
+
+    if(replayed)
+        REDasm::log(QString("Restored %1 unsaved edit(s)").arg(replayed).toStdString());
+
     ui->action_Close->setEnabled(true);
 }
 
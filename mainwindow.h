@@ -3,12 +3,16 @@
 
 #include <QMainWindow>
 #include <QPushButton>
+#include <QProgressBar>
+#include <QFutureWatcher>
 #include <QFileInfo>
 #include <QLabel>
 #include <redasm/plugins/plugins.h>
 #include <redasm/disassembler/disassembler.h>
 #include "widgets/disassemblerview/disassemblerview.h"
 #include "dialogs/loaderdialog/loaderdialog.h"
+#include "databasesaver.h"
+#include "editjournal.h"
 
 namespace Ui {
 class MainWindow;
@@ -18,6 +22,9 @@ class MainWindow : public QMainWindow
 {
     Q_OBJECT
 
+    private:
+        struct LoadedDatabase { REDasm::Disassembler* disassembler; QString filename, error; };
+
     public:
         explicit MainWindow(QWidget *parent = 0);
         ~MainWindow();
@@ -33,6 +40,8 @@ class MainWindow : public QMainWindow
         void onOpenClicked();
         void onSaveClicked();
         void onSaveAsClicked();
+        void onDatabaseSaved(bool ok);
+        void onDatabaseLoaded();
         void onRecentFileClicked();
         void onExitClicked();
         void onSignaturesClicked();
@@ -49,7 +58,10 @@ class MainWindow : public QMainWindow
         REDasm::DisassemblerAPI* currentDisassembler() const;
         void loadWindowState();
         void loadRecents();
-        bool loadDatabase(const QString& filepath);
+        void loadDatabase(const QString& filepath);
+        void loadBinary(const QString& filepath);
+        void saveDatabase(REDasm::DisassemblerAPI* disassembler, const QString& rdbpath);
+        QString databasePath() const;
         void load(const QString &filepath);
         void checkCommandLine();
         void setStandardActionsEnabled(bool b);
@@ -58,6 +70,7 @@ class MainWindow : public QMainWindow
         void setViewWidgetsVisible(bool b);
         void configureWebEngine();
         bool canClose();
+        bool keepEdits();
 
     private:
         Ui::MainWindow *ui;
@@ -66,6 +79,14 @@ class MainWindow : public QMainWindow
         QStringList m_recents;
         QPushButton* m_pbstatus;
         QPushButton* m_pbproblems;
+        QProgressBar* m_pbworking;
+        QFutureWatcher<LoadedDatabase> m_loadwatcher;
+        QString m_loadpath, m_queuedpath; // Opened while a dropped load was still running
+        DatabaseSaver* m_saver;
+        EditJournal* m_journal;
+        QString m_savepath;
+        qint64 m_journalmark;
+        bool m_loaddropped;
 };
 
 #endif // MAINWINDOW_H
@@ -0,0 +1,63 @@
+#include "mappedbuffer.h"
+#include <redasm/buffer/memorybuffer.h>
+#include <algorithm>
+#include <cstring>
+
+MappedBuffer::MappedBuffer(): m_data(nullptr), m_size(0) { }
+MappedBuffer::~MappedBuffer() { this->unmap(); }
+u8 *MappedBuffer::data() const { return m_data; }
+u64 MappedBuffer::size() const { return m_size; }
+
+void MappedBuffer::resize(u64 size)
+{
+    m_heap.resize(size);
+
+    if(m_file.isOpen()) // Move to the heap, the new size may not fit the mapping
+    {
+        std::memcpy(m_heap.data(), m_data, std::min(size, m_size));
+        this->unmap();
+    }
+
+    m_data = m_heap.data();
+    m_size = size;
+}
+
+REDasm::AbstractBuffer *MappedBuffer::fromFile(const QString &filepath)
+{
+    MappedBuffer* buffer = new MappedBuffer();
+
+    if(buffer->map(filepath))
+        return buffer;
+
+    // Pipes, some network filesystems and address space exhaustion (32 bit) end up here
+    delete buffer;
+    return REDasm::MemoryBuffer::fromFile(filepath.toStdString());
+}
+
+bool MappedBuffer::map(const QString &filepath)
+{
+    m_file.setFileName(filepath);
+
+    if(!m_file.open(QFile::ReadOnly) || (m_file.size() <= 0))
+        return false;
+
+    m_data = m_file.map(0, m_file.size(), QFile::MapPrivateOption);
+
+    if(!m_data)
+    {
+        m_file.close();
+        return false;
+    }
+
+    m_size = static_cast<u64>(m_file.size());
+    return true;
+}
+
+void MappedBuffer::unmap()
+{
+    if(!m_file.isOpen()) // Not mapped or already moved to the heap
+        return;
+
+    m_file.unmap(m_data);
+    m_file.close();
+}
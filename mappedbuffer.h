@@ -0,0 +1,34 @@
+#ifndef MAPPEDBUFFER_H
+#define MAPPEDBUFFER_H
+
+#include <QString>
+#include <QFile>
+#include <vector>
+#include <redasm/buffer/abstractbuffer.h>
+
+// Input buffer backed by a private (copy on write) mapping of the file: pages are read when
+// they are touched and the loaders can still patch bytes without changing the file on disk.
+class MappedBuffer : public REDasm::AbstractBuffer
+{
+    public:
+        ~MappedBuffer();
+        u8* data() const override;
+        u64 size() const override;
+        void resize(u64 size) override;
+
+    public:
+        static REDasm::AbstractBuffer* fromFile(const QString& filepath);
+
+    private:
+        MappedBuffer();
+        bool map(const QString& filepath);
+        void unmap();
+
+    private:
+        QFile m_file;
+        std::vector<u8> m_heap; // Used once resized, a mapping cannot grow
+        u8* m_data;
+        u64 m_size;
+};
+
+#endif // MAPPEDBUFFER_H
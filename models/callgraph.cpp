@@ -0,0 +1,184 @@
+#include "callgraph.h"
+#include "../workchunks.h"
+#include "disassemblerregistry.h"
+#include <QtConcurrent>
+#include <QTimer>
+#include <algorithm>
+
+#define CALLGRAPH_CHUNK_SIZE   256 // Functions per worker
+#define CALLGRAPH_BUILD_DELAY  500 // ms
+
+int CallGraph::Graph::functionIndex(address_t address) const
+{
+    auto it = std::lower_bound(functions.begin(), functions.end(), address);
+
+    if((it == functions.end()) || (*it != address))
+        return -1;
+
+    return static_cast<int>(it - functions.begin());
+}
+
+int CallGraph::Graph::callsCount(int function) const { return (function != -1) ? (offsets[function + 1] - offsets[function]) : 0; }
+const CallGraph::Call *CallGraph::Graph::callsBegin(int function) const { return calls.constData() + offsets[function]; }
+bool CallGraph::Graph::isCalleeLocked(const Call &call) const { return (call.callee != -1) ? locked[call.callee] : call.locked; }
+
+CallGraph::CallGraph(const REDasm::DisassemblerPtr &disassembler, QObject *parent): QObject(parent), m_disassembler(disassembler), m_stop(false), m_dirty(false)
+{
+    connect(&m_watcher, &QFutureWatcher<void>::finished, this, [&]() {
+        emit graphChanged();
+
+        if(m_dirty) // Changed while building
+            this->scheduleBuild();
+    });
+
+    EVENT_CONNECT(m_disassembler->document(), changed, this, [&](const REDasm::ListingDocumentChanged* ldc) {
+        if(m_disassembler->busy())
+            return;
+
+        if(ldc->item->is(REDasm::ListingItem::InstructionItem))
+        {
+            if(!ldc->isInserted() && !ldc->isRemoved())
+                return;
+        }
+        else if(!ldc->item->is(REDasm::ListingItem::FunctionItem)) // Renames too: names are part of the graph
+            return;
+
+        if(!m_dirty.exchange(true))
+            QMetaObject::invokeMethod(this, "scheduleBuild", Qt::QueuedConnection);
+    });
+
+    EVENT_CONNECT(m_disassembler, busyChanged, this, [&]() {
+        if(!m_disassembler->busy())
+            QMetaObject::invokeMethod(this, "startBuild", Qt::QueuedConnection);
+    });
+
+    if(!m_disassembler->busy()) // Loaded from a database
+        QMetaObject::invokeMethod(this, "startBuild", Qt::QueuedConnection);
+}
+
+CallGraph::~CallGraph()
+{
+    EVENT_DISCONNECT(m_disassembler->document(), changed, this);
+    EVENT_DISCONNECT(m_disassembler, busyChanged, this);
+
+    m_stop = true;
+    m_watcher.waitForFinished();
+}
+
+CallGraph::GraphPtr CallGraph::graph() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_graph;
+}
+
+std::shared_ptr<CallGraph> CallGraph::get(const REDasm::DisassemblerPtr &disassembler) { return DisassemblerRegistry<CallGraph>::get(disassembler); }
+
+void CallGraph::scheduleBuild() { QTimer::singleShot(CALLGRAPH_BUILD_DELAY, this, &CallGraph::startBuild); }
+
+void CallGraph::startBuild()
+{
+    if(m_watcher.isRunning() || m_disassembler->busy())
+        return;
+
+    m_dirty = false;
+    m_watcher.setFuture(QtConcurrent::run([&]() { this->build(); }));
+}
+
+void CallGraph::build()
+{
+    auto graph = std::make_shared<Graph>();
+
+    {
+        auto lock = REDasm::s_lock_safe_ptr(m_disassembler->document());
+
+        for(const REDasm::ListingItem* item : lock->functions())
+            graph->functions.push_back(item->address);
+    }
+
+    std::sort(graph->functions.begin(), graph->functions.end());
+    graph->functions.erase(std::unique(graph->functions.begin(), graph->functions.end()), graph->functions.end());
+
+    auto chunks = workChunks<int>(0, graph->functions.size(), CALLGRAPH_CHUNK_SIZE);
+
+    // The document is locked by each query: workers must not run under a lock held here
+    graph->names.resize(graph->functions.size());
+    graph->locked.resize(graph->functions.size());
+
+    auto results = QtConcurrent::blockingMapped< QVector< QVector< QVector<Call> > > >(chunks, [&](const QPair<int, int>& chunk) -> QVector< QVector<Call> > {
+        QVector< QVector<Call> > chunkcalls;
+
+        for(int i = chunk.first; !m_stop && (i < chunk.second); i++)
+        {
+            const REDasm::Symbol* symbol = m_disassembler->document()->symbol(graph->functions[i]);
+            QVector<Call> calls;
+
+            if(symbol)
+            {
+                graph->names[i] = QString::fromStdString(symbol->name);
+                graph->locked[i] = symbol->isLocked();
+            }
+
+            for(const REDasm::ListingItem* item : m_disassembler->getCalls(graph->functions[i]))
+            {
+                int callee = -1;
+                bool locked = false;
+
+                if(item->is(REDasm::ListingItem::InstructionItem))
+                {
+                    REDasm::InstructionPtr instruction = m_disassembler->document()->instruction(item->address);
+
+                    if(instruction && instruction->is(REDasm::InstructionType::Call))
+                    {
+                        address_location location = m_disassembler->getTarget(item->address);
+
+                        if(location.valid)
+                            callee = graph->functionIndex(location);
+                    }
+                }
+
+                if(callee == -1) // Imports and other targets that aren't functions
+                {
+                    const REDasm::Symbol* targetsymbol = m_disassembler->document()->symbol(item->address);
+
+                    if(item->is(REDasm::ListingItem::InstructionItem))
+                    {
+                        REDasm::ReferenceSet targets = m_disassembler->getTargets(item->address);
+
+                        if(!targets.empty())
+                            targetsymbol = m_disassembler->document()->symbol(*targets.begin());
+                    }
+
+                    locked = targetsymbol && targetsymbol->isLocked();
+                }
+
+                calls.push_back({ item->address, callee, m_disassembler->getReferencesCount(item->address), locked });
+            }
+
+            chunkcalls.push_back(calls);
+        }
+
+        return chunkcalls;
+    });
+
+    if(m_stop)
+        return;
+
+    graph->offsets.reserve(graph->functions.size() + 1);
+
+    for(const auto& result : results)
+    {
+        for(const QVector<Call>& calls : result)
+        {
+            graph->offsets.push_back(graph->calls.size());
+            graph->calls += calls;
+        }
+    }
+
+    graph->offsets.push_back(graph->calls.size());
+
+    if(graph->offsets.size() != (graph->functions.size() + 1)) // Stopped halfway
+        return;
+
+    QMutexLocker locker(&m_mutex);
+    m_graph = graph;
+}
@@ -0,0 +1,66 @@
+#ifndef CALLGRAPH_H
+#define CALLGRAPH_H
+
+#include <QObject>
+#include <QVector>
+#include <QMutex>
+#include <QFutureWatcher>
+#include <atomic>
+#include <memory>
+#include <redasm/disassembler/disassemblerapi.h>
+#include <redasm/disassembler/listing/listingdocument.h>
+
+// Caller -> callee edges of every function, shared by the call tree models of a disassembler.
+// Built in parallel when the analysis ends and rebuilt (debounced) when functions or instructions change:
+// readers keep an immutable snapshot, so a rebuild never invalidates an expanded tree.
+class CallGraph : public QObject
+{
+    Q_OBJECT
+
+    public:
+        // 'callee' is a function index, -1 if it isn't a known function ('locked' is the call target's symbol, then)
+        struct Call { address_t address; int callee; u64 references; bool locked; };
+
+        struct Graph
+        {
+            QVector<address_t> functions;  // Sorted function addresses...
+            QVector<int> offsets;          // ...and the range of their calls (CSR)
+            QVector<Call> calls;
+            QVector<QString> names;        // Symbol of each function, resolved with the calls
+            QVector<bool> locked;
+
+            int functionIndex(address_t address) const;
+            int callsCount(int function) const;
+            const Call* callsBegin(int function) const;
+            bool isCalleeLocked(const Call& call) const;
+        };
+
+        typedef std::shared_ptr<const Graph> GraphPtr;
+
+    public:
+        explicit CallGraph(const REDasm::DisassemblerPtr& disassembler, QObject *parent = nullptr);
+        ~CallGraph();
+        GraphPtr graph() const;
+
+    public:
+        static std::shared_ptr<CallGraph> get(const REDasm::DisassemblerPtr& disassembler);
+
+    private slots:
+        void scheduleBuild();
+        void startBuild();
+
+    private:
+        void build();
+
+    signals:
+        void graphChanged();
+
+    private:
+        REDasm::DisassemblerPtr m_disassembler;
+        GraphPtr m_graph;
+        QFutureWatcher<void> m_watcher;
+        mutable QMutex m_mutex;
+        std::atomic<bool> m_stop, m_dirty;
+};
+
+#endif // CALLGRAPH_H
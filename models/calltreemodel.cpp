@@ -1,179 +1,359 @@
 #include "calltreemodel.h"
 #include <redasm/plugins/loader.h>
 #include "../themeprovider.h"
+#include <QtConcurrent>
 #include <QFontDatabase>
+#include <QTimer>
 #include <QColor>
+#include <QQueue>
+#include <QSet>
 
-CallTreeModel::CallTreeModel(QObject *parent) : QAbstractItemModel(parent), m_disassembler(nullptr), m_root(nullptr) { }
+#define ROOT_NODE          0
+#define EXPAND_NODE_BUDGET 100000 // Nodes added by a single expansion
+#define EXPAND_BATCH_ROWS  2048   // Rows inserted per event loop iteration
+
+CallTreeModel::CallTreeModel(QObject *parent) : QAbstractItemModel(parent), m_disassembler(nullptr), m_generation(0), m_pendingroot(0), m_planposition(0), m_pending(false), m_expanding(false), m_applying(false)
+{
+    qRegisterMetaType< QVector<int> >("QVector<int>");
+    connect(this, &CallTreeModel::expansionReady, this, &CallTreeModel::onExpansionReady, Qt::QueuedConnection);
+}
+
+CallTreeModel::~CallTreeModel() { this->cancelExpansion(); }
 
 void CallTreeModel::setDisassembler(const REDasm::DisassemblerPtr &disassembler)
 {
+    if(m_callgraph)
+        disconnect(m_callgraph.get(), &CallGraph::graphChanged, this, nullptr);
+
+    this->clearGraph();
     m_disassembler = disassembler;
     m_printer = REDasm::PrinterPtr(m_disassembler->assembler()->createPrinter(m_disassembler.get()));
+    m_callgraph = CallGraph::get(disassembler);
+    connect(m_callgraph.get(), &CallGraph::graphChanged, this, &CallTreeModel::onGraphChanged);
 }
 
 void CallTreeModel::initializeGraph(address_t address)
 {
-    this->clearGraph();
+    if(!m_pending && !m_nodes.empty() && m_callgraph && (m_graph == m_callgraph->graph()) && (this->nodeAddress(m_nodes[ROOT_NODE]) == address))
+        return; // Same function, keep the expanded nodes
 
-    REDasm::ListingDocument& document = m_disassembler->document();
-    auto it = document->functionItem(address);
+    this->cancelExpansion();
+    this->beginResetModel();
+    m_nodes.clear();
+    m_depths.clear();
+    m_texts.clear();
+    m_graph = m_callgraph ? m_callgraph->graph() : nullptr;
+    m_pending = !m_graph; // Still building, show it when ready
+    m_pendingroot = address;
 
-    if(it == document->end())
-        return;
+    int function = m_graph ? m_graph->functionIndex(address) : -1;
 
-    m_root = it->get();
-    m_depths[m_root] = 0;
-    m_parents[m_root] = nullptr;
-    this->populate(m_root);
+    if(function != -1)
+    {
+        m_nodes.push_back({ -1, 0, 0, -1, function, -1, 0, false });
+        this->populate(ROOT_NODE);
+    }
+
+    this->endResetModel();
 }
 
 void CallTreeModel::clearGraph()
 {
+    this->cancelExpansion();
     this->beginResetModel();
-    m_root = nullptr;
+    m_nodes.clear();
     m_depths.clear();
-    m_children.clear();
-    m_parents.clear();
+    m_texts.clear();
+    m_graph = nullptr;
+    m_pending = false;
     this->endResetModel();
 }
 
-void CallTreeModel::populateCallGraph(const QModelIndex &index) { this->populate(reinterpret_cast<REDasm::ListingItem*>(index.internalPointer())); }
+void CallTreeModel::expand(const QModelIndex &index, int depth)
+{
+    if(!index.isValid() || m_nodes.empty() || m_expanding)
+        return;
+
+    m_expanding = true; // Node ids must not change until the plan is applied
+
+    int generation = m_generation.load(), nodeid = static_cast<int>(index.internalId());
+    CallGraph::GraphPtr graph = m_graph;
+    QVector<Node> nodes = m_nodes;
+    QHash<int, int> depths = m_depths;
+
+    m_future = QtConcurrent::run([=]() {
+        QVector<int> plan = CallTreeModel::planExpansion(graph.get(), nodes, depths, nodeid, depth, m_generation, generation);
+
+        if(generation == m_generation.load())
+            emit expansionReady(generation, plan);
+    });
+}
+
+void CallTreeModel::populateCallGraph(const QModelIndex &index)
+{
+    if(!index.isValid() || m_nodes.empty() || m_applying) // Nodes of the plan are populated already
+        return;
+
+    if(m_expanding)
+    {
+        m_deferred.push_back(index);
+        return;
+    }
+
+    int nodeid = static_cast<int>(index.internalId());
+
+    if(m_nodes[nodeid].populated || !this->hasChildren(index))
+        return;
+
+    int count = m_graph->callsCount(m_nodes[nodeid].callee);
+    this->beginInsertRows(index, 0, count - 1);
+    this->populate(nodeid);
+    this->endInsertRows();
+}
+
+void CallTreeModel::onGraphChanged()
+{
+    if(m_pending)
+        this->initializeGraph(m_pendingroot);
+}
 
-void CallTreeModel::populate(REDasm::ListingItem* parentitem)
+void CallTreeModel::onExpansionReady(int generation, const QVector<int> &plan)
 {
-    if(m_children.contains(parentitem))
+    if(generation != m_generation.load())
         return;
 
-    REDasm::ListingItems calls;
+    m_plan = plan;
+    m_planposition = 0;
+    this->applyExpansion();
+}
+
+void CallTreeModel::applyExpansion()
+{
+    if(!m_expanding)
+        return;
 
-    if(parentitem->is(REDasm::ListingItem::InstructionItem))
+    QModelIndexList indexes;
+    int rows = 0;
+
+    for( ; (m_planposition < m_plan.size()) && (rows < EXPAND_BATCH_ROWS); m_planposition++)
     {
-        auto location = this->getCallTarget(parentitem);
+        int nodeid = m_plan[m_planposition];
+        QModelIndex index = this->createIndex(m_nodes[nodeid].row, 0, nodeid);
+
+        if(!m_nodes[nodeid].populated)
+        {
+            int count = m_graph->callsCount(m_nodes[nodeid].callee);
+            this->beginInsertRows(index, 0, count - 1);
+            this->populate(nodeid);
+            this->endInsertRows();
+            rows += count;
+        }
 
-        if(location.valid)
-            calls = m_disassembler->getCalls(location);
+        indexes.push_back(index);
     }
-    else if(parentitem->is(REDasm::ListingItem::FunctionItem))
-        calls = m_disassembler->getCalls(parentitem->address);
 
-    if(calls.empty())
+    m_applying = true; // The view reports every node of the batch as 'expanded'
+    emit nodesExpanded(indexes);
+    m_applying = false;
+
+    if(m_planposition < m_plan.size())
+    {
+        QTimer::singleShot(0, this, &CallTreeModel::applyExpansion); // Let the view breathe
         return;
+    }
+
+    QModelIndexList deferred;
+    deferred.swap(m_deferred);
+    m_plan.clear();
+    m_expanding = false;
+
+    for(const QModelIndex& index : deferred)
+        this->populateCallGraph(index);
+}
+
+void CallTreeModel::cancelExpansion()
+{
+    m_generation.fetchAndAddOrdered(1);
+    m_future.waitForFinished();
+    m_plan.clear();
+    m_deferred.clear();
+    m_expanding = false;
+}
 
-    QModelIndex index;
+void CallTreeModel::populate(int nodeid) { CallTreeModel::populate(m_graph.get(), m_nodes, m_depths, nodeid); }
+bool CallTreeModel::isDuplicate(int nodeid) const { return CallTreeModel::isDuplicate(m_nodes, m_depths, nodeid); }
 
-    if(parentitem != m_root)
-        index = this->createIndex(this->getParentIndex(parentitem), 0, parentitem);
+void CallTreeModel::populate(const CallGraph::Graph *graph, QVector<Node> &nodes, QHash<int, int> &depths, int nodeid)
+{
+    if(nodes[nodeid].populated)
+        return;
 
-    this->beginInsertRows(index, 0, static_cast<int>(calls.size()));
-    m_children[parentitem] = calls;
+    int firstchild = nodes.size(), count = graph->callsCount(nodes[nodeid].callee);
+    int depth = nodes[nodeid].depth + 1;
+    const CallGraph::Call* calls = count ? graph->callsBegin(nodes[nodeid].callee) : nullptr;
 
-    for(REDasm::ListingItem* item : m_children[parentitem])
+    nodes[nodeid].firstchild = firstchild;
+    nodes[nodeid].childcount = count;
+    nodes[nodeid].populated = true;
+    nodes.reserve(nodes.size() + count);
+
+    for(int i = 0; i < count; i++)
     {
-        m_parents[item] = parentitem;
+        int call = graph->offsets[nodes[nodeid].callee] + i;
+        nodes.push_back({ nodeid, i, depth, call, calls[i].callee, -1, 0, false });
 
-        if(!m_depths.contains(item))
-            m_depths[item] = m_depths[parentitem] + 1;
+        if(!depths.contains(call))
+            depths[call] = depth;
     }
-
-    this->endInsertRows();
 }
 
-bool CallTreeModel::isDuplicate(const QModelIndex &index) const
+bool CallTreeModel::isDuplicate(const QVector<Node> &nodes, const QHash<int, int> &depths, int nodeid)
 {
-    REDasm::ListingItem* item = reinterpret_cast<REDasm::ListingItem*>(index.internalPointer());
+    const Node& node = nodes[nodeid];
 
-    if(item == m_root)
+    if(node.parent == -1)
         return false;
 
-    QModelIndex parentindex = this->parent(index);
-    REDasm::ListingItem* parentitem = reinterpret_cast<REDasm::ListingItem*>(parentindex.internalPointer());
-    return (m_depths[item] - m_depths[parentitem]) != 1;
+    const Node& parentnode = nodes[node.parent];
+    int parentdepth = (parentnode.call != -1) ? depths.value(parentnode.call) : 0;
+    return (depths.value(node.call) - parentdepth) != 1; // Already shown at a lower depth (or a recursion)
 }
 
-int CallTreeModel::getParentIndexFromChild(REDasm::ListingItem *childitem) const
+QVector<int> CallTreeModel::planExpansion(const CallGraph::Graph *graph, QVector<Node> nodes, QHash<int, int> depths, int nodeid, int depth, const QAtomicInt &generation, int currentgeneration)
 {
-    if(childitem == m_root)
-        return -1;
+    QVector<int> plan;
+    QSet<int> expandedcalls; // A call site is expanded once, other occurrences stay collapsed
+    QQueue<int> queue;
+    int startdepth = nodes[nodeid].depth, budget = nodes.size() + EXPAND_NODE_BUDGET;
+
+    for(const Node& node : nodes)
+    {
+        if(node.populated && (node.call != -1))
+            expandedcalls.insert(node.call);
+    }
+
+    queue.enqueue(nodeid);
+
+    // Breadth first: calls get their lowest depth, so duplicates are detected like a manual expansion
+    while(!queue.empty() && (generation.load() == currentgeneration))
+    {
+        int id = queue.dequeue();
+
+        if(((depth != -1) && ((nodes[id].depth - startdepth) >= depth)) || CallTreeModel::isDuplicate(nodes, depths, id))
+            continue;
+
+        if(!nodes[id].populated)
+        {
+            if(!graph->callsCount(nodes[id].callee) || ((id != nodeid) && expandedcalls.contains(nodes[id].call)))
+                continue;
 
-    REDasm::ListingItem* parentitem = m_parents[childitem];
-    return this->getParentIndex(parentitem);
+            if((nodes.size() + graph->callsCount(nodes[id].callee)) > budget)
+                break;
+
+            CallTreeModel::populate(graph, nodes, depths, id);
+
+            if(nodes[id].call != -1)
+                expandedcalls.insert(nodes[id].call);
+        }
+
+        plan.push_back(id);
+
+        for(int i = 0; i < nodes[id].childcount; i++)
+            queue.enqueue(nodes[id].firstchild + i);
+    }
+
+    return plan;
 }
 
-int CallTreeModel::getParentIndex(REDasm::ListingItem *parentitem) const
+address_t CallTreeModel::nodeAddress(const Node &node) const
 {
-    const REDasm::ListingItems& parentlist = m_children[m_parents[parentitem]];
-    return std::distance(parentlist.begin(), std::find(parentlist.begin(), parentlist.end(), parentitem));
+    if(node.call == -1)
+        return m_graph->functions[node.callee];
+
+    return m_graph->calls[node.call].address;
 }
 
-address_location CallTreeModel::getCallTarget(const REDasm::ListingItem *item) const
+bool CallTreeModel::isCalleeLocked(const Node &node) const { return (node.call == -1) ? m_graph->locked[node.callee] : m_graph->isCalleeLocked(m_graph->calls[node.call]); }
+
+QString CallTreeModel::nodeText(int nodeid) const
 {
-    if(!item->is(REDasm::ListingItem::InstructionItem))
-        return REDasm::invalid_location<address_t>();
+    auto it = m_texts.find(nodeid);
+
+    if(it != m_texts.end())
+        return it.value();
+
+    const Node& node = m_nodes[nodeid];
+    QString text;
+
+    if(node.call == -1)
+        text = m_graph->names[node.callee];
+    else
+    {
+        REDasm::InstructionPtr instruction = m_disassembler->document()->instruction(this->nodeAddress(node));
 
-    REDasm::InstructionPtr instruction = m_disassembler->document()->instruction(item->address);
+        if(instruction)
+            text = QString::fromStdString(m_printer->out(instruction));
+    }
+
+    m_texts[nodeid] = text;
+    return text;
+}
 
-    if(!instruction->is(REDasm::InstructionType::Call))
-        return REDasm::invalid_location<address_t>();
+const REDasm::ListingItem *CallTreeModel::item(const QModelIndex &index) const
+{
+    if(!m_disassembler || !index.isValid() || m_nodes.empty())
+        return nullptr;
 
-    return m_disassembler->getTarget(item->address);
+    const Node& node = m_nodes[static_cast<int>(index.internalId())];
+    auto lock = REDasm::s_lock_safe_ptr(m_disassembler->document());
+    auto it = (node.call == -1) ? lock->functionItem(this->nodeAddress(node)) : lock->instructionItem(this->nodeAddress(node));
+    return (it != lock->end()) ? it->get() : nullptr;
 }
 
 bool CallTreeModel::hasChildren(const QModelIndex &parentindex) const
 {
-    if(!m_disassembler || !m_root || m_children.empty())
+    if(!m_disassembler || m_nodes.empty())
         return false;
 
-    REDasm::ListingItem* parentitem = reinterpret_cast<REDasm::ListingItem*>(parentindex.internalPointer());
-
-    if(!parentitem)
+    if(!parentindex.isValid())
         return true;
 
-    if(this->isDuplicate(parentindex))
-        return false;
-
-    if(m_children.contains(parentitem))
-    {
-        const REDasm::ListingItems& children = m_children[parentitem];
-
-        if(children.empty())
-            return false;
-    }
+    int nodeid = static_cast<int>(parentindex.internalId());
 
-    if(parentitem->is(REDasm::ListingItem::InstructionItem))
-    {
-        auto location = this->getCallTarget(parentitem);
-        return location.valid ? !m_disassembler->getCalls(location).empty() : false;
-    }
+    if(this->isDuplicate(nodeid))
+        return false;
 
-    return true;
+    const Node& node = m_nodes[nodeid];
+    return node.populated ? (node.childcount > 0) : (m_graph->callsCount(node.callee) > 0);
 }
 
 QModelIndex CallTreeModel::index(int row, int column, const QModelIndex &parent) const
 {
-    if(!m_disassembler || !m_root || m_children.empty())
+    if(!m_disassembler || m_nodes.empty())
         return QModelIndex();
 
-    REDasm::ListingItem* parentitem = reinterpret_cast<REDasm::ListingItem*>(parent.internalPointer());
+    if(!parent.isValid())
+        return this->createIndex(row, column, ROOT_NODE);
 
-    if(!parentitem)
-        return this->createIndex(row, column, m_root);
+    const Node& parentnode = m_nodes[static_cast<int>(parent.internalId())];
 
-    return this->createIndex(row, column, m_children[parentitem][row]);
+    if(!parentnode.populated || (row < 0) || (row >= parentnode.childcount))
+        return QModelIndex();
+
+    return this->createIndex(row, column, parentnode.firstchild + row);
 }
 
 QModelIndex CallTreeModel::parent(const QModelIndex &child) const
 {
-    if(!m_disassembler || !m_root)
+    if(!m_disassembler || !child.isValid() || m_nodes.empty())
         return QModelIndex();
 
-    REDasm::ListingItem* childitem = reinterpret_cast<REDasm::ListingItem*>(child.internalPointer());
+    const Node& node = m_nodes[static_cast<int>(child.internalId())];
 
-    if(childitem == m_root)
+    if(node.parent == -1)
         return QModelIndex();
 
-    REDasm::ListingItem* parentitem = m_parents[childitem];
-    return this->createIndex(this->getParentIndexFromChild(childitem), 0, parentitem);
+    return this->createIndex(m_nodes[node.parent].row, 0, node.parent);
 }
 
 QVariant CallTreeModel::headerData(int section, Qt::Orientation orientation, int role) const
@@ -200,44 +380,33 @@ QVariant CallTreeModel::headerData(int section, Qt::Orientation orientation, int
 
 QVariant CallTreeModel::data(const QModelIndex &index, int role) const
 {
-    if(!m_disassembler || m_disassembler->busy() || !m_root)
+    if(!m_disassembler || m_disassembler->busy() || m_nodes.empty() || !index.isValid())
         return QVariant();
 
-    auto lock = REDasm::s_lock_safe_ptr(m_disassembler->document());
-    REDasm::ListingItem* item = reinterpret_cast<REDasm::ListingItem*>(index.internalPointer());
-    const REDasm::Symbol* symbol = lock->symbol(item->address);
-
-    if(item->is(REDasm::ListingItem::InstructionItem))
-    {
-        REDasm::ReferenceSet refs = m_disassembler->getTargets(item->address);
-
-        if(!refs.empty())
-            symbol = lock->symbol(*refs.begin());
-    }
+    int nodeid = static_cast<int>(index.internalId());
+    const Node& node = m_nodes[nodeid];
 
     if(role == Qt::DisplayRole)
     {
         if(index.column() == 0)
-            return QString::fromStdString(REDasm::hex(item->address, m_disassembler->assembler()->bits()));
+            return QString::fromStdString(REDasm::hex(this->nodeAddress(node), m_disassembler->assembler()->bits()));
         else if(index.column() == 1)
-        {
-            if(item->is(REDasm::ListingItem::FunctionItem))
-                return QString::fromStdString(symbol->name);
-
-            return QString::fromStdString(m_printer->out(lock->instruction(item->address)));
-        }
+            return this->nodeText(nodeid);
         else if(index.column() == 2)
-            return item == m_root ? "---" : QString::number(m_disassembler->getReferencesCount(item->address));
+            return (node.parent == -1) ? "---" : QString::number(m_graph->calls[node.call].references);
     }
     else if(role == Qt::ForegroundRole)
     {
         if(index.column() == 0)
             return QColor(Qt::darkBlue);
-        else if((index.column() == 1) && this->isDuplicate(index) && !symbol->isLocked())
+        else if((index.column() == 1) && this->isDuplicate(nodeid) && !this->isCalleeLocked(node))
             return QColor(Qt::gray);
     }
-    else if(role == Qt::BackgroundColorRole && symbol && symbol->isLocked())
-        return THEME_VALUE("locked_bg");
+    else if(role == Qt::BackgroundColorRole)
+    {
+        if(this->isCalleeLocked(node))
+            return THEME_VALUE("locked_bg");
+    }
     else if((role == Qt::TextAlignmentRole) && (index.column() == 2))
         return Qt::AlignCenter;
 
@@ -248,13 +417,11 @@ int CallTreeModel::columnCount(const QModelIndex &parent) const { Q_UNUSED(paren
 
 int CallTreeModel::rowCount(const QModelIndex &parent) const
 {
-    if(!m_disassembler || m_disassembler->busy() || !m_root || m_children.empty())
+    if(!m_disassembler || m_disassembler->busy() || m_nodes.empty())
         return 0;
 
-    REDasm::ListingItem* parentitem = reinterpret_cast<REDasm::ListingItem*>(parent.internalPointer());
-
-    if(!parentitem)
+    if(!parent.isValid())
         return 1;
 
-    return static_cast<int>(m_children[parentitem].size());
+    return m_nodes[static_cast<int>(parent.internalId())].childcount;
 }
@@ -2,32 +2,57 @@
 #define CALLTREEMODEL_H
 
 #include <QAbstractItemModel>
+#include <QAtomicInt>
+#include <QFuture>
 #include <QHash>
 #include <redasm/disassembler/disassemblerapi.h>
 #include <redasm/plugins/assembler/printer.h>
 #include <redasm/disassembler/listing/listingdocument.h>
+#include "callgraph.h"
 
 class CallTreeModel : public QAbstractItemModel
 {
     Q_OBJECT
 
+    private:
+        struct Node
+        {
+            int parent, row, depth;
+            int call;                  // Index in the call graph, -1 for the root function
+            int callee;                // Function expanded by this node
+            int firstchild, childcount;
+            bool populated;
+        };
+
     public:
         explicit CallTreeModel(QObject *parent = nullptr);
+        ~CallTreeModel();
         void setDisassembler(const REDasm::DisassemblerPtr& disassembler);
         void initializeGraph(address_t address);
         void clearGraph();
+        void expand(const QModelIndex& index, int depth = -1); // -1: until every reachable call is shown
 
     public slots:
         void populateCallGraph(const QModelIndex& index);
 
+    private slots:
+        void onGraphChanged();
+        void onExpansionReady(int generation, const QVector<int>& plan);
+        void applyExpansion();
+
     private:
-        void populate(REDasm::ListingItem *parentitem);
-        bool isDuplicate(const QModelIndex& index) const;
-        int getParentIndexFromChild(REDasm::ListingItem *childitem) const;
-        int getParentIndex(REDasm::ListingItem *parentitem) const;
+        void populate(int nodeid);
+        bool isDuplicate(int nodeid) const;
+        void cancelExpansion();
+        static void populate(const CallGraph::Graph* graph, QVector<Node>& nodes, QHash<int, int>& depths, int nodeid);
+        static bool isDuplicate(const QVector<Node>& nodes, const QHash<int, int>& depths, int nodeid);
+        static QVector<int> planExpansion(const CallGraph::Graph* graph, QVector<Node> nodes, QHash<int, int> depths, int nodeid, int depth, const QAtomicInt& generation, int currentgeneration);
+        address_t nodeAddress(const Node& node) const;
+        bool isCalleeLocked(const Node& node) const;
+        QString nodeText(int nodeid) const;
 
     public:
-        address_location getCallTarget(const REDasm::ListingItem *item) const;
+        const REDasm::ListingItem* item(const QModelIndex& index) const;
         bool hasChildren(const QModelIndex& parentindex) const override;
         QModelIndex index(int row, int column, const QModelIndex &parent) const override;
         QModelIndex parent(const QModelIndex &child) const override;
@@ -36,13 +61,25 @@ class CallTreeModel : public QAbstractItemModel
         int columnCount(const QModelIndex& parent) const override;
         int rowCount(const QModelIndex& parent) const override;
 
+    signals:
+        void expansionReady(int generation, const QVector<int>& plan);
+        void nodesExpanded(const QModelIndexList& indexes); // Handled synchronously, the view expands each index
+
     private:
         REDasm::PrinterPtr m_printer;
         REDasm::DisassemblerPtr m_disassembler;
-        REDasm::ListingItem* m_root;
-        QHash<REDasm::ListingItem*, s32> m_depths;
-        QHash<REDasm::ListingItem*, REDasm::ListingItems> m_children;
-        QHash<REDasm::ListingItem*, REDasm::ListingItem*> m_parents;
+        std::shared_ptr<CallGraph> m_callgraph;
+        CallGraph::GraphPtr m_graph;   // Snapshot of the tree being shown
+        QVector<Node> m_nodes;         // Siblings are contiguous, node 0 is the root
+        QHash<int, int> m_depths;      // First depth of a call
+        mutable QHash<int, QString> m_texts;
+        QVector<int> m_plan;           // Nodes to expand, in insertion order
+        QModelIndexList m_deferred;    // Expanded by hand while a plan was running
+        QAtomicInt m_generation;
+        QFuture<void> m_future;
+        address_t m_pendingroot;
+        int m_planposition;
+        bool m_pending, m_expanding, m_applying;
 };
 
 #endif // CALLTREEMODEL_H
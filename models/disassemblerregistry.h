@@ -0,0 +1,36 @@
+#ifndef DISASSEMBLERREGISTRY_H
+#define DISASSEMBLERREGISTRY_H
+
+#include <QHash>
+#include <memory>
+#include <redasm/disassembler/disassemblerapi.h>
+
+// One instance of T per disassembler, shared by its models and alive while someone holds it (GUI thread only)
+template<typename T> class DisassemblerRegistry
+{
+    public:
+        static std::shared_ptr<T> get(const REDasm::DisassemblerPtr& disassembler)
+        {
+            static QHash< REDasm::DisassemblerAPI*, std::weak_ptr<T> > instances;
+
+            for(auto it = instances.begin(); it != instances.end(); )
+            {
+                if(it->expired())
+                    it = instances.erase(it);
+                else
+                    it++;
+            }
+
+            std::shared_ptr<T> instance = instances.value(disassembler.get()).lock();
+
+            if(!instance)
+            {
+                instance = std::make_shared<T>(disassembler);
+                instances[disassembler.get()] = instance;
+            }
+
+            return instance;
+        }
+};
+
+#endif // DISASSEMBLERREGISTRY_H
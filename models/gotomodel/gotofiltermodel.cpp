@@ -1,32 +1,210 @@
 #include "gotofiltermodel.h"
+#include "../../workchunks.h"
+#include <QtConcurrent>
+#include <algorithm>
 
-GotoFilterModel::GotoFilterModel(QObject *parent) : QSortFilterProxyModel(parent)
+#define GOTO_GROUP_SIZE 65536 // Entries per published batch
+#define GOTO_CHUNK_SIZE 4096  // Entries per worker
+#define GOTO_TOP_COUNT  500
+
+GotoFilterModel::GotoFilterModel(QObject *parent) : QSortFilterProxyModel(parent), m_generation(0), m_ranked(false)
+{
+    qRegisterMetaType< QVector<int> >("QVector<int>");
+
+    GotoModel* gotomodel = new GotoModel(this);
+    this->setSourceModel(gotomodel);
+
+    connect(this, &GotoFilterModel::filterReady, this, &GotoFilterModel::onFilterReady, Qt::QueuedConnection);
+    connect(gotomodel, &GotoModel::loaded, this, &GotoFilterModel::updateFiltering); // Rows streamed in after the query
+}
+
+GotoFilterModel::~GotoFilterModel()
+{
+    this->cancelFiltering();
+
+    for(QFuture<void>& future : m_futures) // Stale queries still reference this model
+        future.waitForFinished();
+}
+
+void GotoFilterModel::setDisassembler(const REDasm::DisassemblerPtr &disassembler)
 {
-    this->setFilterKeyColumn(-1);
-    this->setFilterCaseSensitivity(Qt::CaseInsensitive);
-    this->setSourceModel(new GotoModel(this));
+    this->cancelFiltering();
+    static_cast<GotoModel*>(this->sourceModel())->setDisassembler(disassembler);
+    m_searchindex = SymbolSearchIndex::get(disassembler);
 }
 
-void GotoFilterModel::setDisassembler(const REDasm::DisassemblerPtr &disassembler) { static_cast<GotoModel*>(this->sourceModel())->setDisassembler(disassembler); }
+void GotoFilterModel::setFilter(const QString &filter)
+{
+    if(filter == m_filter)
+        return;
+
+    m_filter = filter;
+    this->updateFiltering();
+}
 
 bool GotoFilterModel::filterAcceptsRow(int sourcerow, const QModelIndex &sourceparent) const
 {
-    const REDasm::ListingItem* item = reinterpret_cast<const REDasm::ListingItem*>(this->sourceModel()->index(sourcerow, 0, sourceparent).internalPointer());
+    Q_UNUSED(sourceparent)
+
+    if(m_filter.isEmpty())
+        return true;
+
+    return (sourcerow < m_ranks.size()) && (m_ranks[sourcerow] != -1); // Newer rows wait for the next pass
+}
+
+bool GotoFilterModel::lessThan(const QModelIndex &left, const QModelIndex &right) const
+{
+    if(!m_ranked || (left.row() >= m_ranks.size()) || (right.row() >= m_ranks.size()))
+        return left.row() < right.row();
+
+    return m_ranks[left.row()] < m_ranks[right.row()];
+}
+
+void GotoFilterModel::onFilterReady(int generation, const QVector<int> &ranks)
+{
+    if(generation != m_generation.load())
+        return;
+
+    m_ranks = ranks;
+    this->invalidateFilter();
+    this->sort(m_ranked ? 0 : -1); // Best match first
+}
+
+void GotoFilterModel::updateFiltering()
+{
+    this->cancelFiltering();
+
+    SymbolMatcher matcher(m_filter);
+    GotoModel* gotomodel = static_cast<GotoModel*>(this->sourceModel());
+    m_ranked = matcher.isRanked();
+
+    if(m_filter.isEmpty() || !matcher.isValid())
+    {
+        m_ranks.clear();
+        this->invalidateFilter();
+        this->sort(-1);
+        return;
+    }
+
+    QVector<address_t> matches;
+    QSet<address_t> candidates;
+    bool indexed = !m_ranked && m_searchindex && m_searchindex->query(m_filter, &matches);
 
-    if(!item)
-        return false;
+    if(indexed)
+        candidates = QSet<address_t>::fromList(matches.toList());
 
-    switch(item->type)
+    QSet<size_t> types; // Not indexed, matched once per type
+
+    for(size_t type : { REDasm::ListingItem::SegmentItem, REDasm::ListingItem::FunctionItem, REDasm::ListingItem::TypeItem, REDasm::ListingItem::SymbolItem })
     {
-        case REDasm::ListingItem::SegmentItem:
-        case REDasm::ListingItem::FunctionItem:
-        case REDasm::ListingItem::SymbolItem:
-        case REDasm::ListingItem::TypeItem:
-            return QSortFilterProxyModel::filterAcceptsRow(sourcerow, sourceparent);
-
-        default:
-            break;
+        if(matcher.score(GotoModel::itemType(type)) != SYMBOLMATCHER_NOMATCH)
+            types.insert(type);
     }
 
-    return false;
+    int generation = m_generation.load();
+    QVector<GotoModel::Entry> entries = gotomodel->entries(); // Implicitly shared, rows are only appended
+    m_futures.push_back(QtConcurrent::run([=]() { this->filterEntries(generation, matcher, entries, candidates, types, indexed); }));
+}
+
+void GotoFilterModel::filterEntries(int generation, const SymbolMatcher &matcher, const QVector<GotoModel::Entry> &entries, const QSet<address_t> &candidates, const QSet<size_t> &types, bool indexed)
+{
+    QVector<int> ranks(entries.size(), -1);
+    QVector< QPair<int, int> > top; // Best (row, score) so far, ranked modes only
+    bool published = false;
+
+    for(int start = 0; (start < entries.size()) && (generation == m_generation.load()); start += GOTO_GROUP_SIZE)
+    {
+        int end = std::min(start + GOTO_GROUP_SIZE, entries.size());
+        auto chunks = workChunks<int>(start, end, GOTO_CHUNK_SIZE);
+
+        // Scores of the group, ranked modes only look at the name
+        QVector<int> scores(end - start, SYMBOLMATCHER_NOMATCH);
+
+        QtConcurrent::blockingMap(chunks, [&](const QPair<int, int>& chunk) {
+            for(int i = chunk.first; (i < chunk.second) && (generation == m_generation.load()); i++)
+            {
+                const GotoModel::Entry& entry = entries[i];
+
+                if(matcher.isRanked())
+                    scores[i - start] = matcher.score(entry.name);
+                else if(indexed && !candidates.contains(entry.address) && !types.contains(entry.type)) // Index hits still need a check
+                    scores[i - start] = SYMBOLMATCHER_NOMATCH;
+                else
+                {
+                    scores[i - start] = std::max({ matcher.score(entry.addresstext), matcher.score(entry.name),
+                                                   matcher.score(GotoModel::itemType(entry.type)) });
+                }
+            }
+        });
+
+        if(generation != m_generation.load())
+            return;
+
+        bool changed = false;
+
+        if(matcher.isRanked())
+        {
+            QVector< QPair<int, int> > rows = top;
+
+            for(int i = 0; i < scores.size(); i++)
+            {
+                if(scores[i] == SYMBOLMATCHER_NOMATCH)
+                    continue;
+
+                rows.push_back(qMakePair(start + i, scores[i]));
+                changed = true;
+            }
+
+            if(!changed)
+                continue;
+
+            auto bestfirst = [](const QPair<int, int>& a, const QPair<int, int>& b) -> bool {
+                return (a.second != b.second) ? (a.second > b.second) : (a.first < b.first);
+            };
+
+            int count = std::min(rows.size(), GOTO_TOP_COUNT);
+            std::partial_sort(rows.begin(), rows.begin() + count, rows.end(), bestfirst);
+
+            for(const auto& row : top) // Rows pushed out of the top are filtered again
+                ranks[row.first] = -1;
+
+            top = rows.mid(0, count);
+
+            for(int i = 0; i < top.size(); i++)
+                ranks[top[i].first] = i;
+        }
+        else
+        {
+            for(int i = 0; i < scores.size(); i++)
+            {
+                if(scores[i] == SYMBOLMATCHER_NOMATCH)
+                    continue;
+
+                ranks[start + i] = start + i;
+                changed = true;
+            }
+        }
+
+        if(!changed)
+            continue;
+
+        emit filterReady(generation, ranks); // Refined by every group
+        published = true;
+    }
+
+    if(!published && (generation == m_generation.load())) // Nothing matched, clear the previous results
+        emit filterReady(generation, ranks);
+}
+
+void GotoFilterModel::cancelFiltering()
+{
+    m_generation.fetchAndAddOrdered(1); // Workers check it on every entry and drop their results
+
+    for(auto it = m_futures.begin(); it != m_futures.end(); )
+    {
+        if(it->isFinished())
+            it = m_futures.erase(it);
+        else
+            it++;
+    }
 }
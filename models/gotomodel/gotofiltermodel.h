@@ -2,7 +2,13 @@
 #define GOTOFILTERMODEL_H
 
 #include <QSortFilterProxyModel>
+#include <QAtomicInt>
+#include <QFuture>
+#include <QList>
+#include <QSet>
 #include "gotomodel.h"
+#include "../symbolsearchindex.h"
+#include "../symbolmatcher.h"
 
 class GotoFilterModel : public QSortFilterProxyModel
 {
@@ -10,10 +16,32 @@ class GotoFilterModel : public QSortFilterProxyModel
 
     public:
         explicit GotoFilterModel(QObject *parent = nullptr);
+        ~GotoFilterModel();
         void setDisassembler(const REDasm::DisassemblerPtr &disassembler);
+        void setFilter(const QString& filter);
 
     protected:
         bool filterAcceptsRow(int sourcerow, const QModelIndex &sourceparent) const override;
+        bool lessThan(const QModelIndex& left, const QModelIndex& right) const override;
+
+    private slots:
+        void onFilterReady(int generation, const QVector<int>& ranks);
+        void updateFiltering();
+
+    private:
+        void filterEntries(int generation, const SymbolMatcher& matcher, const QVector<GotoModel::Entry>& entries, const QSet<address_t>& candidates, const QSet<size_t>& types, bool indexed);
+        void cancelFiltering();
+
+    signals:
+        void filterReady(int generation, const QVector<int>& ranks);
+
+    private:
+        std::shared_ptr<SymbolSearchIndex> m_searchindex;
+        QVector<int> m_ranks; // Position of each source row in the results, -1 if filtered out
+        QString m_filter;
+        QAtomicInt m_generation;
+        QList< QFuture<void> > m_futures; // Cancelled queries finish on their own
+        bool m_ranked;
 };
 
 #endif // GOTOFILTERMODEL_H
@@ -1,34 +1,78 @@
 #include "gotomodel.h"
+#include "../../workchunks.h"
 #include "../../themeprovider.h"
 #include <redasm/disassembler/disassembler.h>
+#include <QtConcurrent>
 
-GotoModel::GotoModel(QObject *parent) : DisassemblerModel(parent) { }
+#define GOTO_GROUP_SIZE 65536 // Items scanned per document lock
+#define GOTO_CHUNK_SIZE 4096  // Items scanned per worker
+
+GotoModel::GotoModel(QObject *parent) : DisassemblerModel(parent), m_generation(0)
+{
+    qRegisterMetaType< QVector<GotoModel::Entry> >("QVector<GotoModel::Entry>");
+
+    connect(this, &GotoModel::entriesReady, this, &GotoModel::onEntriesReady, Qt::QueuedConnection);
+    connect(&m_watcher, &QFutureWatcher<void>::finished, this, &GotoModel::loaded);
+}
+
+GotoModel::~GotoModel()
+{
+    m_generation.fetchAndAddOrdered(1);
+    m_watcher.waitForFinished();
+}
 
 void GotoModel::setDisassembler(const REDasm::DisassemblerPtr &disassembler)
 {
+    m_generation.fetchAndAddOrdered(1);
+    m_watcher.waitForFinished();
+
     this->beginResetModel();
     DisassemblerModel::setDisassembler(disassembler);
+    m_names = SymbolNameCache::get(disassembler);
+    m_entries.clear();
     this->endResetModel();
+
+    int generation = m_generation.load();
+    m_watcher.setFuture(QtConcurrent::run([=]() { this->loadEntries(generation); }));
 }
 
-QVariant GotoModel::data(const QModelIndex &index, int role) const
+const REDasm::ListingItem *GotoModel::item(const QModelIndex &index) const
 {
-    if(!m_disassembler)
-        return QVariant();
+    if(!m_disassembler || !index.isValid() || (index.row() >= m_entries.size()))
+        return nullptr;
+
+    const Entry& entry = m_entries[index.row()];
+    auto lock = REDasm::s_lock_safe_ptr(m_disassembler->document());
+    REDasm::ListingDocumentType::const_iterator it = lock->end();
+
+    if(entry.type == REDasm::ListingItem::SegmentItem)
+        it = lock->segmentItem(entry.address);
+    else if(entry.type == REDasm::ListingItem::FunctionItem)
+        it = lock->functionItem(entry.address);
+    else
+        it = lock->symbolItem(entry.address); // Types are declared at their symbol
 
-    const REDasm::ListingItem* item = reinterpret_cast<const REDasm::ListingItem*>(index.internalPointer());
+    return (it != lock->end()) ? it->get() : nullptr;
+}
+
+const QVector<GotoModel::Entry> &GotoModel::entries() const { return m_entries; }
+bool GotoModel::isLoading() const { return m_watcher.isRunning(); }
 
-    if(!item)
+QVariant GotoModel::data(const QModelIndex &index, int role) const
+{
+    if(!m_disassembler || !index.isValid() || (index.row() >= m_entries.size()))
         return QVariant();
 
+    const Entry& entry = m_entries[index.row()];
+
     if(role == Qt::DisplayRole)
     {
         if(index.column() == 0)
-            return S_TO_QS(REDasm::hex(item->address, m_disassembler->assembler()->bits()));
+            return entry.addresstext;
         if(index.column() == 1)
-            return this->itemName(item);
+            return entry.name;
         if(index.column() == 2)
-            return this->itemType(item);
+            return GotoModel::itemType(entry.type);
     }
     else if(role == Qt::TextAlignmentRole)
     {
@@ -41,7 +85,7 @@ QVariant GotoModel::data(const QModelIndex &index, int role) const
             return THEME_VALUE("address_list_fg");
 
         if(index.column() == 1)
-            return this->itemColor(item);
+            return this->itemColor(entry);
     }
 
     return QVariant();
@@ -65,77 +109,113 @@ QVariant GotoModel::headerData(int section, Qt::Orientation orientation, int rol
     return DisassemblerModel::headerData(section, orientation, role);
 }
 
-QModelIndex GotoModel::index(int row, int column, const QModelIndex &parent) const
+int GotoModel::columnCount(const QModelIndex &) const { return 3; }
+int GotoModel::rowCount(const QModelIndex &) const { return m_entries.size(); }
+
+QString GotoModel::itemType(size_t type)
 {
-    if(!m_disassembler)
-        return QModelIndex();
+    if(type == REDasm::ListingItem::SegmentItem)
+        return "SEGMENT";
+    if(type == REDasm::ListingItem::FunctionItem)
+        return "FUNCTION";
+    if(type == REDasm::ListingItem::TypeItem)
+        return "TYPE";
+    if(type == REDasm::ListingItem::SymbolItem)
+        return "SYMBOL";
 
-    return this->createIndex(row, column, m_disassembler->document()->itemAt(row));
+    return QString();
 }
 
-int GotoModel::columnCount(const QModelIndex &) const { return 3; }
-int GotoModel::rowCount(const QModelIndex &) const { return m_disassembler ? m_disassembler->document()->size() : 0; }
+void GotoModel::onEntriesReady(int generation, const QVector<GotoModel::Entry> &entries)
+{
+    if(generation != m_generation.load())
+        return;
+
+    this->beginInsertRows(QModelIndex(), m_entries.size(), m_entries.size() + entries.size() - 1);
+    m_entries += entries;
+    this->endInsertRows();
+}
 
-QColor GotoModel::itemColor(const REDasm::ListingItem *item) const
+void GotoModel::loadEntries(int generation)
 {
-    if(item->type == REDasm::ListingItem::SegmentItem)
-        return THEME_VALUE("segment_fg");
-    if(item->type == REDasm::ListingItem::FunctionItem)
-        return THEME_VALUE("function_fg");
-    if(item->type == REDasm::ListingItem::TypeItem)
-        return THEME_VALUE("type_fg");
+    int bits = m_disassembler->assembler()->bits();
 
-    if(item->type == REDasm::ListingItem::SymbolItem)
+    for(size_t start = 0; generation == m_generation.load(); start += GOTO_GROUP_SIZE)
     {
-        const REDasm::ListingDocument& document = m_disassembler->document();
-        const REDasm::Symbol* symbol = document->symbol(item->address);
+        auto lock = REDasm::s_lock_safe_ptr(m_disassembler->document());
+        size_t end = std::min(start + GOTO_GROUP_SIZE, lock->size());
 
-        if(!symbol)
-            return QColor();
+        if(start >= end)
+            break;
 
-        if(symbol->is(REDasm::SymbolType::String))
-            return THEME_VALUE("string_fg");
+        auto chunks = workChunks<size_t>(start, end, GOTO_CHUNK_SIZE);
 
-        return THEME_VALUE("data_fg");
-    }
+        auto results = QtConcurrent::blockingMapped< QVector< QVector<Entry> > >(chunks, [&](const QPair<size_t, size_t>& chunk) -> QVector<Entry> {
+            QVector<Entry> entries;
 
-    return QColor();
-}
+            for(size_t i = chunk.first; i < chunk.second; i++)
+            {
+                const REDasm::ListingItem* item = lock->itemAt(i);
 
-QString GotoModel::itemName(const REDasm::ListingItem *item) const
-{
-    const REDasm::ListingDocument& document = m_disassembler->document();
+                if(!item->is(REDasm::ListingItem::SegmentItem) && !item->is(REDasm::ListingItem::FunctionItem) &&
+                   !item->is(REDasm::ListingItem::SymbolItem) && !item->is(REDasm::ListingItem::TypeItem))
+                    continue;
 
-    if(item->type == REDasm::ListingItem::SegmentItem)
-    {
-        const REDasm::Segment* segment = document->segment(item->address);
+                Entry entry = { item->address, item->type, S_TO_QS(REDasm::hex(item->address, bits)), QString(), false };
 
-        if(segment)
-            return S_TO_QS(segment->name);
-    }
-    else if((item->type == REDasm::ListingItem::FunctionItem) || (item->type == REDasm::ListingItem::SymbolItem))
-    {
-        const REDasm::Symbol* symbol = document->symbol(item->address);
+                if(item->is(REDasm::ListingItem::SegmentItem))
+                {
+                    const REDasm::Segment* segment = lock->segment(item->address);
 
-        if(symbol)
-            return S_TO_QS(REDasm::Demangler::demangled(symbol->name));
-    }
-    else if(item->type == REDasm::ListingItem::TypeItem)
-        return S_TO_QS(document->type(item));
+                    if(segment)
+                        entry.name = S_TO_QS(segment->name);
+                }
+                else if(item->is(REDasm::ListingItem::TypeItem))
+                    entry.name = S_TO_QS(lock->type(item));
+                else
+                {
+                    const REDasm::Symbol* symbol = lock->symbol(item->address);
 
-    return QString();
+                    if(symbol && symbol->is(REDasm::SymbolType::StringMask)) // Show the label, not the contents
+                        entry.name = S_TO_QS(symbol->name);
+                    else if(symbol)
+                        entry.name = m_names->name(symbol);
+
+                    entry.string = symbol && symbol->is(REDasm::SymbolType::String);
+                }
+
+                entries.push_back(entry);
+            }
+
+            return entries;
+        });
+
+        QVector<Entry> entries;
+
+        for(const QVector<Entry>& result : results)
+            entries += result;
+
+        if(!entries.empty())
+            emit entriesReady(generation, entries);
+    }
 }
 
-QString GotoModel::itemType(const REDasm::ListingItem *item) const
+QColor GotoModel::itemColor(const Entry &entry) const
 {
-    if(item->type == REDasm::ListingItem::SegmentItem)
-        return "SEGMENT";
-    if(item->type == REDasm::ListingItem::FunctionItem)
-        return "FUNCTION";
-    if(item->type == REDasm::ListingItem::TypeItem)
-        return "TYPE";
-    if(item->type == REDasm::ListingItem::SymbolItem)
-        return "SYMBOL";
+    if(entry.type == REDasm::ListingItem::SegmentItem)
+        return THEME_VALUE("segment_fg");
+    if(entry.type == REDasm::ListingItem::FunctionItem)
+        return THEME_VALUE("function_fg");
+    if(entry.type == REDasm::ListingItem::TypeItem)
+        return THEME_VALUE("type_fg");
 
-    return QString();
+    if(entry.type == REDasm::ListingItem::SymbolItem)
+    {
+        if(entry.string)
+            return THEME_VALUE("string_fg");
+
+        return THEME_VALUE("data_fg");
+    }
+
+    return QColor();
 }
@@ -1,27 +1,61 @@
 #ifndef GOTOMODEL_H
 #define GOTOMODEL_H
 
+#include <QFutureWatcher>
+#include <QAtomicInt>
 #include "../listingitemmodel.h"
+#include "../symbolnamecache.h"
 
+// Segments, functions, symbols and types only: the listing is walked once in the background
+// and the model keeps a compact array of rows with their display strings already built.
 class GotoModel : public DisassemblerModel
 {
     Q_OBJECT
 
+    public:
+        struct Entry
+        {
+            address_t address;
+            size_t type;
+            QString addresstext, name;
+            bool string;
+        };
+
     public:
         explicit GotoModel(QObject *parent = nullptr);
+        ~GotoModel();
         void setDisassembler(const REDasm::DisassemblerPtr &disassembler) override;
+        const REDasm::ListingItem* item(const QModelIndex& index) const;
+        const QVector<Entry>& entries() const;
+        bool isLoading() const;
 
     public:
         QVariant data(const QModelIndex &index, int role) const override;
         QVariant headerData(int section, Qt::Orientation orientation, int role) const override;
-        QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
         int columnCount(const QModelIndex&) const override;
         int rowCount(const QModelIndex&) const override;
 
+    public:
+        static QString itemType(size_t type);
+
+    private slots:
+        void onEntriesReady(int generation, const QVector<GotoModel::Entry>& entries);
+
     private:
-        QColor itemColor(const REDasm::ListingItem* item) const;
-        QString itemName(const REDasm::ListingItem* item) const;
-        QString itemType(const REDasm::ListingItem* item) const;
+        void loadEntries(int generation);
+        QColor itemColor(const Entry& entry) const;
+
+    signals:
+        void entriesReady(int generation, const QVector<GotoModel::Entry>& entries);
+        void loaded();
+
+    private:
+        std::shared_ptr<SymbolNameCache> m_names;
+        QVector<Entry> m_entries;
+        QFutureWatcher<void> m_watcher;
+        QAtomicInt m_generation;
 };
 
+Q_DECLARE_METATYPE(GotoModel::Entry)
+
 #endif // GOTOMODEL_H
@@ -1,11 +1,36 @@
 #include "listingfiltermodel.h"
+#include "../workchunks.h"
+#include <QtConcurrent>
 
-#define FILTER_MIN_CHARS 2
+#define FILTER_MIN_CHARS  2
+#define FILTER_GROUP_SIZE 16384 // Items per published batch
+#define FILTER_CHUNK_SIZE 1024  // Items per worker
+#define FILTER_TOP_COUNT  1000   // Ranked results
+
+ListingFilterModel::ListingFilterModel(QObject *parent) : QIdentityProxyModel(parent), m_generation(0)
+{
+    qRegisterMetaType< QVector<address_t> >("QVector<address_t>");
+
+    connect(this, &ListingFilterModel::filterBatchReady, this, &ListingFilterModel::onFilterBatchReady, Qt::QueuedConnection);
+    connect(this, &ListingFilterModel::filterRanked, this, &ListingFilterModel::onFilterRanked, Qt::QueuedConnection);
+    connect(this, &ListingFilterModel::filterFinished, this, &ListingFilterModel::onFilterFinished, Qt::QueuedConnection);
+}
+
+ListingFilterModel::~ListingFilterModel()
+{
+    this->cancelFiltering();
+
+    for(QFuture<void>& future : m_futures) // Stale queries still reference this model
+        future.waitForFinished();
+}
 
-ListingFilterModel::ListingFilterModel(QObject *parent) : QIdentityProxyModel(parent) { }
 const QString &ListingFilterModel::filter() const { return m_filterstring; }
 const REDasm::ListingItem *ListingFilterModel::item(const QModelIndex &index) const { return static_cast<ListingItemModel*>(this->sourceModel())->item(this->mapToSource(index));  }
-void ListingFilterModel::setDisassembler(const REDasm::DisassemblerPtr& disassembler) { static_cast<ListingItemModel*>(this->sourceModel())->setDisassembler(disassembler); }
+void ListingFilterModel::setDisassembler(const REDasm::DisassemblerPtr& disassembler)
+{
+    static_cast<ListingItemModel*>(this->sourceModel())->setDisassembler(disassembler);
+    m_searchindex = SymbolSearchIndex::get(disassembler);
+}
 
 void ListingFilterModel::setFilter(const QString &filter)
 {
@@ -77,32 +102,195 @@ QModelIndex ListingFilterModel::mapToSource(const QModelIndex &proxyindex) const
     return listingitemmodel->index(idx, proxyindex.column());
 }
 
-void ListingFilterModel::updateFiltering()
+void ListingFilterModel::onFilterBatchReady(int generation, const QVector<address_t> &addresses)
 {
-    this->beginResetModel();
-    m_filtereditems.clear();
+    if(generation != m_generation.load())
+        return;
+
+    this->beginInsertRows(QModelIndex(), m_filtereditems.size(), m_filtereditems.size() + addresses.size() - 1);
+    m_filtereditems += addresses;
+    this->endInsertRows();
+}
+
+void ListingFilterModel::onFilterRanked(int generation, const QVector<address_t> &addresses)
+{
+    if(generation != m_generation.load())
+        return;
+
+    this->beginResetModel(); // Better matches can show up anywhere
+    m_filtereditems = addresses;
+    this->endResetModel();
+}
 
-    if(this->canFilter())
+void ListingFilterModel::onFilterFinished(int generation)
+{
+    if((generation != m_generation.load()) || SymbolMatcher(m_filterstring).isRanked()) // Ranked results are truncated
+        return;
+
+    m_completedfilter = m_filterstring;
+}
+
+void ListingFilterModel::filterAddresses(int generation, const QString &filter, const QVector<address_t> &candidates)
+{
+    ListingItemModel* listingitemmodel = static_cast<ListingItemModel*>(this->sourceModel());
+
+    for(int start = 0; (start < candidates.size()) && (generation == m_generation.load()); start += FILTER_GROUP_SIZE)
     {
-        ListingItemModel* listingitemmodel = reinterpret_cast<ListingItemModel*>(this->sourceModel());
+        int end = std::min(start + FILTER_GROUP_SIZE, candidates.size());
+        QStringList texts = listingitemmodel->filterTexts(candidates, start, end); // Workers never touch the document
+        auto chunks = workChunks<int>(start, end, FILTER_CHUNK_SIZE);
 
-        for(int i = 0; i < listingitemmodel->rowCount(); i++)
-        {
-            for(int j = 0; j < listingitemmodel->columnCount(); j++)
+        auto results = QtConcurrent::blockingMapped< QVector< QVector<address_t> > >(chunks, [&](const QPair<int, int>& chunk) -> QVector<address_t> {
+            QVector<address_t> matches;
+
+            for(int i = chunk.first; (i < chunk.second) && (generation == m_generation.load()); i++)
             {
-                QModelIndex index = listingitemmodel->index(i, j);
-                QVariant data = listingitemmodel->data(index);
+                if(texts[i - start].contains(filter, Qt::CaseInsensitive))
+                    matches.push_back(candidates[i]);
+            }
+
+            return matches;
+        });
+
+        if(generation != m_generation.load()) // Superseded by a newer query
+            return;
+
+        QVector<address_t> batch;
+
+        for(const QVector<address_t>& result : results)
+            batch += result;
+
+        if(!batch.empty())
+            emit filterBatchReady(generation, batch);
+    }
+
+    emit filterFinished(generation);
+}
+
+void ListingFilterModel::rankAddresses(int generation, const SymbolMatcher &matcher, const QVector<address_t> &candidates)
+{
+    ListingItemModel* listingitemmodel = static_cast<ListingItemModel*>(this->sourceModel());
+    QVector<SymbolMatcher::Match> top;
+
+    for(int start = 0; (start < candidates.size()) && (generation == m_generation.load()); start += FILTER_GROUP_SIZE)
+    {
+        int end = std::min(start + FILTER_GROUP_SIZE, candidates.size());
+        QStringList names = listingitemmodel->searchNames(candidates, start, end); // Workers only score
+        auto chunks = workChunks<int>(start, end, FILTER_CHUNK_SIZE);
 
-                if((data.type() != QVariant::String) || (data.toString().indexOf(m_filterstring, 0, Qt::CaseInsensitive) == -1))
-                    continue;
+        auto results = QtConcurrent::blockingMapped< QVector< QVector<SymbolMatcher::Match> > >(chunks, [&](const QPair<int, int>& chunk) -> QVector<SymbolMatcher::Match> {
+            QVector<SymbolMatcher::Match> matches;
 
-                m_filtereditems.push_back(listingitemmodel->address(index));
-                break;
+            for(int i = chunk.first; (i < chunk.second) && (generation == m_generation.load()); i++)
+            {
+                int score = matcher.score(names[i - start]);
+
+                if(score != SYMBOLMATCHER_NOMATCH)
+                    matches.push_back({ candidates[i], score });
             }
+
+            return matches;
+        });
+
+        if(generation != m_generation.load())
+            return;
+
+        bool changed = false;
+
+        for(const QVector<SymbolMatcher::Match>& result : results)
+        {
+            if(result.empty())
+                continue;
+
+            SymbolMatcher::mergeTop(top, result, FILTER_TOP_COUNT);
+            changed = true;
         }
+
+        if(!changed)
+            continue;
+
+        QVector<address_t> ranked; // Best matches so far, refined by every group
+        ranked.reserve(top.size());
+
+        for(const SymbolMatcher::Match& match : top)
+            ranked.push_back(match.address);
+
+        emit filterRanked(generation, ranked);
     }
 
+    emit filterFinished(generation);
+}
+
+void ListingFilterModel::cancelFiltering()
+{
+    m_generation.fetchAndAddOrdered(1); // Workers check it on every item and drop their results
+
+    for(auto it = m_futures.begin(); it != m_futures.end(); )
+    {
+        if(it->isFinished())
+            it = m_futures.erase(it);
+        else
+            it++;
+    }
+}
+
+void ListingFilterModel::updateFiltering()
+{
+    this->cancelFiltering();
+
+    QVector<address_t> candidates;
+    SymbolMatcher matcher(m_filterstring);
+    bool narrow = !m_completedfilter.isEmpty() && m_filterstring.contains(m_completedfilter, Qt::CaseInsensitive);
+
+    if(this->canFilter() && matcher.isRanked())
+        candidates = static_cast<ListingItemModel*>(this->sourceModel())->addresses();
+    else if(this->canFilter() && !this->indexedCandidates(&candidates)) // Index hits are verified against this model's columns
+    {
+        if(narrow) // An extended query can only match a subset of the previous results
+            candidates = m_filtereditems;
+        else
+            candidates = static_cast<ListingItemModel*>(this->sourceModel())->addresses();
+    }
+
+    this->beginResetModel();
+    m_filtereditems.clear();
+    m_completedfilter.clear();
     this->endResetModel();
+
+    if(!this->canFilter() || !matcher.isValid())
+        return;
+
+    int generation = m_generation.load();
+    QString filter = m_filterstring;
+
+    if(matcher.isRanked())
+        m_futures.push_back(QtConcurrent::run([=]() { this->rankAddresses(generation, matcher, candidates); }));
+    else
+        m_futures.push_back(QtConcurrent::run([=]() { this->filterAddresses(generation, filter, candidates); }));
+}
+
+bool ListingFilterModel::indexedCandidates(QVector<address_t> *candidates) const
+{
+    QVector<address_t> matches;
+    bool ok = false;
+    m_filterstring.toULongLong(&ok);
+
+    if(ok) // Might be a reference count, these aren't indexed
+        return false;
+
+    if(!m_searchindex || !m_searchindex->query(m_filterstring, &matches))
+        return false;
+
+    ListingItemModel* listingitemmodel = static_cast<ListingItemModel*>(this->sourceModel());
+    candidates->clear();
+
+    for(address_t address : matches) // Index hits cover every model, keep this model's rows
+    {
+        if(listingitemmodel->m_items.indexOf(address) != REDasm::npos)
+            candidates->push_back(address);
+    }
+
+    return true;
 }
 
 bool ListingFilterModel::canFilter() const { return m_filterstring.length() >= FILTER_MIN_CHARS; }
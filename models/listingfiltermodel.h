@@ -2,7 +2,12 @@
 #define LISTINGFILTERMODEL_H
 
 #include <QSortFilterProxyModel>
+#include <QAtomicInt>
+#include <QFuture>
+#include <QList>
 #include "listingitemmodel.h"
+#include "symbolsearchindex.h"
+#include "symbolmatcher.h"
 
 class ListingFilterModel : public QIdentityProxyModel
 {
@@ -10,6 +15,7 @@ class ListingFilterModel : public QIdentityProxyModel
 
     public:
         explicit ListingFilterModel(QObject *parent = nullptr);
+        ~ListingFilterModel();
         const QString& filter() const;
         const REDasm::ListingItem* item(const QModelIndex& index) const;
         void setDisassembler(const REDasm::DisassemblerPtr &disassembler);
@@ -22,17 +28,34 @@ class ListingFilterModel : public QIdentityProxyModel
         QModelIndex mapFromSource(const QModelIndex& sourceindex) const override;
         QModelIndex mapToSource(const QModelIndex& proxyindex) const override;
 
+    private slots:
+        void onFilterBatchReady(int generation, const QVector<address_t>& addresses);
+        void onFilterRanked(int generation, const QVector<address_t>& addresses);
+        void onFilterFinished(int generation);
+
     private:
+        void filterAddresses(int generation, const QString& filter, const QVector<address_t>& candidates);
+        void rankAddresses(int generation, const SymbolMatcher& matcher, const QVector<address_t>& candidates);
+        bool indexedCandidates(QVector<address_t>* candidates) const;
+        void cancelFiltering();
         void updateFiltering();
         bool canFilter() const;
 
+    signals:
+        void filterBatchReady(int generation, const QVector<address_t>& addresses);
+        void filterRanked(int generation, const QVector<address_t>& addresses);
+        void filterFinished(int generation);
+
     public:
         template<typename T> static ListingFilterModel* createFilter(QObject* parent);
         template<typename T> static ListingFilterModel* createFilter(size_t filter, QObject* parent);
 
     private:
-        QList<address_t> m_filtereditems;
-        QString m_filterstring;
+        QVector<address_t> m_filtereditems;
+        QString m_filterstring, m_completedfilter; // 'm_completedfilter' produced all of 'm_filtereditems'
+        std::shared_ptr<SymbolSearchIndex> m_searchindex;
+        QAtomicInt m_generation;
+        QList< QFuture<void> > m_futures; // Cancelled queries finish on their own
 };
 
 template<typename T> ListingFilterModel *ListingFilterModel::createFilter(QObject *parent)
@@ -0,0 +1,210 @@
+#include "listingindex.h"
+#include "../workchunks.h"
+#include "disassemblerregistry.h"
+#include <QtConcurrent>
+#include <QTimer>
+
+#define INDEX_GROUP_SIZE 65536 // Items scanned per document lock
+#define INDEX_CHUNK_SIZE 4096  // Items scanned per worker
+#define INDEX_MAX_VIEWS  64 // Bits of ViewMask
+#define INDEX_FLUSH_INTERVAL 100 // ms
+
+bool ListingIndex::View::matchesItem(const REDasm::ListingItem *item) const
+{
+    if((itemtype != REDasm::ListingItem::AllItems) && (itemtype != item->type))
+        return false;
+
+    return !symbolic || item->is(REDasm::ListingItem::FunctionItem) || item->is(REDasm::ListingItem::SymbolItem);
+}
+
+bool ListingIndex::View::matches(const REDasm::ListingItem *item, const REDasm::Symbol *symbol) const
+{
+    if(!this->matchesItem(item))
+        return false;
+
+    return !symbolic || (symbol && symbol->is(symboltype));
+}
+
+ListingIndex::ListingIndex(const REDasm::DisassemblerPtr &disassembler, QObject *parent): QObject(parent), m_disassembler(disassembler), m_stop(false)
+{
+    qRegisterMetaType< QVector<address_t> >("QVector<address_t>");
+    qRegisterMetaType< QVector<ListingIndex::Change> >("QVector<ListingIndex::Change>");
+
+    connect(&m_watcher, &QFutureWatcher<void>::finished, this, &ListingIndex::startBuild); // Views added while building
+    EVENT_CONNECT(m_disassembler->document(), changed, this, std::bind(&ListingIndex::onListingChanged, this, std::placeholders::_1));
+}
+
+ListingIndex::~ListingIndex()
+{
+    EVENT_DISCONNECT(m_disassembler->document(), changed, this);
+
+    m_stop = true;
+    m_watcher.waitForFinished();
+}
+
+int ListingIndex::addView(const ListingIndex::View &view)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if(m_views.size() >= INDEX_MAX_VIEWS)
+        return -1;
+
+    m_views.push_back(view);
+    m_pendingviews.push_back(m_views.size() - 1);
+
+    if(m_pendingviews.size() == 1) // Models are bound together, scan once for all of them
+        QTimer::singleShot(0, this, &ListingIndex::startBuild);
+
+    return m_views.size() - 1;
+}
+
+std::shared_ptr<ListingIndex> ListingIndex::get(const REDasm::DisassemblerPtr &disassembler) { return DisassemblerRegistry<ListingIndex>::get(disassembler); }
+
+void ListingIndex::startBuild()
+{
+    if(m_watcher.isRunning())
+        return;
+
+    QVector<int> views;
+
+    {
+        QMutexLocker locker(&m_mutex);
+        views.swap(m_pendingviews);
+    }
+
+    if(views.empty())
+        return;
+
+    m_watcher.setFuture(QtConcurrent::run([=]() { this->build(views); }));
+}
+
+void ListingIndex::onListingChanged(const REDasm::ListingDocumentChanged *ldc)
+{
+    if(!ldc->isInserted() && !ldc->isRemoved())
+        return;
+
+    const REDasm::Symbol* symbol = ldc->isInserted() ? m_disassembler->document()->symbol(ldc->item->address) : nullptr;
+    ViewMask mask = 0;
+    QMutexLocker locker(&m_mutex);
+
+    for(int i = 0; i < m_views.size(); i++)
+    {
+        // The symbol may be gone already on removal, models drop missing rows anyway
+        bool matches = ldc->isRemoved() ? m_views[i].matchesItem(ldc->item) : m_views[i].matches(ldc->item, symbol);
+
+        if(matches)
+            mask |= (static_cast<ViewMask>(1) << i);
+    }
+
+    if(!mask)
+        return;
+
+    if(m_changes.empty()) // Called from the disassembler's threads
+        QMetaObject::invokeMethod(this, "scheduleFlush", Qt::QueuedConnection);
+
+    m_changes.push_back({ ldc->item->address, mask, ldc->isInserted() });
+}
+
+void ListingIndex::scheduleFlush() { QTimer::singleShot(INDEX_FLUSH_INTERVAL, this, &ListingIndex::flushChanges); }
+
+void ListingIndex::flushChanges()
+{
+    QVector<Change> changes;
+
+    {
+        QMutexLocker locker(&m_mutex);
+        changes.swap(m_changes);
+    }
+
+    if(!changes.empty())
+        emit changesReady(changes);
+}
+
+void ListingIndex::build(const QVector<int> &views)
+{
+    QVector<View> viewlist;
+
+    {
+        QMutexLocker locker(&m_mutex);
+
+        for(int view : views)
+            viewlist.push_back(m_views[view]);
+    }
+
+    address_t lastaddress = 0;
+    size_t lasttype = 0;
+    bool resume = false;
+
+    while(!m_stop)
+    {
+        auto lock = REDasm::s_lock_safe_ptr(m_disassembler->document());
+        size_t start = 0;
+
+        if(resume) // Items may have been inserted or removed between groups: resume after the last key, not at an index
+        {
+            size_t count = lock->size();
+
+            while(count > 0) // Items are sorted by address and type
+            {
+                size_t half = count / 2;
+                const REDasm::ListingItem* item = lock->itemAt(start + half);
+
+                if((item->address < lastaddress) || ((item->address == lastaddress) && (item->type <= lasttype)))
+                {
+                    start += half + 1;
+                    count -= half + 1;
+                }
+                else
+                    count = half;
+            }
+        }
+
+        size_t end = std::min(start + INDEX_GROUP_SIZE, lock->size());
+
+        if(start >= end)
+            break;
+
+        auto chunks = workChunks<size_t>(start, end, INDEX_CHUNK_SIZE);
+
+        // Writers are blocked by 'lock' while the workers read the document
+        auto results = QtConcurrent::blockingMapped< QVector< QVector< QVector<address_t> > > >(chunks, [&](const QPair<size_t, size_t>& chunk) -> QVector< QVector<address_t> > {
+            QVector< QVector<address_t> > addresses(viewlist.size());
+
+            for(size_t i = chunk.first; i < chunk.second; i++)
+            {
+                const REDasm::ListingItem* item = lock->itemAt(i);
+                const REDasm::Symbol* symbol = nullptr;
+                bool symbolfetched = false;
+
+                for(int j = 0; j < viewlist.size(); j++)
+                {
+                    if(viewlist[j].symbolic && !symbolfetched)
+                    {
+                        symbol = lock->symbol(item->address);
+                        symbolfetched = true;
+                    }
+
+                    if(viewlist[j].matches(item, symbol))
+                        addresses[j].push_back(item->address);
+                }
+            }
+
+            return addresses;
+        });
+
+        lastaddress = lock->itemAt(end - 1)->address;
+        lasttype = lock->itemAt(end - 1)->type;
+        resume = true;
+
+        for(int j = 0; j < viewlist.size(); j++)
+        {
+            QVector<address_t> batch;
+
+            for(const auto& result : results)
+                batch += result[j];
+
+            if(!batch.empty()) // Still locked: no removal can be queued before this batch
+                emit batchReady(views[j], batch);
+        }
+    }
+}
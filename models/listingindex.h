@@ -0,0 +1,66 @@
+#ifndef LISTINGINDEX_H
+#define LISTINGINDEX_H
+
+#include <QObject>
+#include <QVector>
+#include <QFutureWatcher>
+#include <QMutex>
+#include <atomic>
+#include <memory>
+#include <redasm/disassembler/disassemblerapi.h>
+#include <redasm/disassembler/listing/listingdocument.h>
+
+// One index per disassembler, shared by every listing model: the document is walked once
+// (in parallel) for all registered views and rows are delivered in address-ordered batches.
+// Live changes are buffered and delivered once per UI tick.
+class ListingIndex : public QObject
+{
+    Q_OBJECT
+
+    public:
+        struct View
+        {
+            size_t itemtype;
+            REDasm::SymbolType symboltype;
+            bool symbolic; // Function/Symbol items whose symbol matches 'symboltype'
+
+            bool matchesItem(const REDasm::ListingItem* item) const;
+            bool matches(const REDasm::ListingItem* item, const REDasm::Symbol* symbol) const;
+        };
+
+        typedef quint64 ViewMask;
+
+        struct Change { address_t address; ViewMask views; bool inserted; };
+
+    public:
+        explicit ListingIndex(const REDasm::DisassemblerPtr& disassembler, QObject *parent = nullptr);
+        ~ListingIndex();
+        int addView(const View& view);
+
+    public:
+        static std::shared_ptr<ListingIndex> get(const REDasm::DisassemblerPtr& disassembler);
+
+    private slots:
+        void startBuild();
+        void scheduleFlush();
+        void flushChanges();
+
+    private:
+        void onListingChanged(const REDasm::ListingDocumentChanged* ldc);
+        void build(const QVector<int>& views);
+
+    signals:
+        void batchReady(int view, const QVector<address_t>& addresses);
+        void changesReady(const QVector<ListingIndex::Change>& changes);
+
+    private:
+        REDasm::DisassemblerPtr m_disassembler;
+        QVector<View> m_views;
+        QVector<int> m_pendingviews;
+        QVector<Change> m_changes;
+        QFutureWatcher<void> m_watcher;
+        mutable QMutex m_mutex;
+        std::atomic<bool> m_stop;
+};
+
+#endif // LISTINGINDEX_H
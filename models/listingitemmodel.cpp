@@ -1,30 +1,34 @@
 #include "listingitemmodel.h"
 #include <redasm/disassembler/listing/listingdocument.h>
-#include <redasm/support/demangler.h>
 #include <redasm/plugins/loader.h>
 #include "../themeprovider.h"
 #include <QColor>
+#include <QHash>
+#include <algorithm>
 
-ListingItemModel::ListingItemModel(size_t itemtype, QObject *parent) : DisassemblerModel(parent), m_itemtype(itemtype) { }
+#define LISTING_RESET_THRESHOLD 1024 // Changes per tick
+
+ListingItemModel::ListingItemModel(size_t itemtype, QObject *parent) : DisassemblerModel(parent), m_itemtype(itemtype), m_indexview(-1) { }
 
 void ListingItemModel::setDisassembler(const REDasm::DisassemblerPtr& disassembler)
 {
     DisassemblerModel::setDisassembler(disassembler);
-    auto& document = m_disassembler->document();
-
-    this->beginResetModel();
 
-    for(auto it = document->begin(); it != document->end(); it++)
-    {
-        if(!this->isItemAllowed(it->get()))
-            continue;
-
-        m_items.insert((*it)->address);
-    }
+    if(m_index)
+        m_index->disconnect(this);
 
+    this->beginResetModel();
+    m_items = REDasm::sorted_container<address_t>();
     this->endResetModel();
 
-    EVENT_CONNECT(document, changed, this, std::bind(&ListingItemModel::onListingChanged, this, std::placeholders::_1));
+    m_names = SymbolNameCache::get(m_disassembler);
+    m_index = ListingIndex::get(m_disassembler); // Rows are streamed in by the shared index
+    connect(m_index.get(), &ListingIndex::batchReady, this, &ListingItemModel::onBatchReady);
+    connect(m_index.get(), &ListingIndex::changesReady, this, &ListingItemModel::onChangesReady);
+    m_indexview = m_index->addView(this->indexView());
+
+    if(m_indexview == -1)
+        REDasm::log("Listing index: too many views, a list will stay empty");
 }
 
 const REDasm::ListingItem *ListingItemModel::item(const QModelIndex &index) const
@@ -58,6 +62,58 @@ address_location ListingItemModel::address(const QModelIndex &index) const
     return REDasm::make_location(m_items[index.row()]);
 }
 
+QVector<address_t> ListingItemModel::addresses() const
+{
+    QVector<address_t> addresses;
+    addresses.reserve(static_cast<int>(m_items.size()));
+
+    for(size_t i = 0; i < m_items.size(); i++)
+        addresses.push_back(m_items[i]);
+
+    return addresses;
+}
+
+QStringList ListingItemModel::filterTexts(const QVector<address_t> &addresses, int first, int last) const
+{
+    QStringList texts;
+    auto lock = REDasm::s_lock_safe_ptr(m_disassembler->document()); // Once per group, workers match the snapshot
+
+    for(int i = first; i < last; i++)
+    {
+        const REDasm::Symbol* symbol = lock->symbol(addresses[i]);
+
+        if(!symbol)
+        {
+            texts.push_back(QString());
+            continue;
+        }
+
+        REDasm::Segment* segment = lock->segment(symbol->address);
+
+        // Searchable columns, a newline never matches across them
+        texts.push_back(S_TO_QS(REDasm::hex(symbol->address, m_disassembler->assembler()->bits())) + "\n" +
+                        m_names->name(symbol) + "\n" +
+                        QString::number(m_disassembler->getReferencesCount(symbol->address)) + "\n" +
+                        (segment ? S_TO_QS(segment->name) : QString("???")));
+    }
+
+    return texts;
+}
+
+QStringList ListingItemModel::searchNames(const QVector<address_t> &addresses, int first, int last) const
+{
+    QStringList names;
+    auto lock = REDasm::s_lock_safe_ptr(m_disassembler->document());
+
+    for(int i = first; i < last; i++)
+    {
+        const REDasm::Symbol* symbol = lock->symbol(addresses[i]);
+        names.push_back(symbol ? m_names->name(symbol) : QString());
+    }
+
+    return names;
+}
+
 QModelIndex ListingItemModel::index(int row, int column, const QModelIndex &parent) const
 {
     Q_UNUSED(parent)
@@ -108,14 +164,7 @@ QVariant ListingItemModel::data(const QModelIndex &index, int role) const
             return S_TO_QS(REDasm::hex(symbol->address, m_disassembler->assembler()->bits()));
 
         if(index.column() == 1)
-        {
-            if(symbol->is(REDasm::SymbolType::WideStringMask))
-                return S_TO_QS(REDasm::quoted(m_disassembler->readWString(symbol)));
-            else if(symbol->is(REDasm::SymbolType::StringMask))
-                return S_TO_QS(REDasm::quoted(m_disassembler->readString(symbol)));
-
-            return S_TO_QS(REDasm::Demangler::demangled(symbol->name));
-        }
+            return m_names->name(symbol);
 
         if(index.column() == 2)
             return QString::number(m_disassembler->getReferencesCount(symbol->address));
@@ -147,31 +196,113 @@ QVariant ListingItemModel::data(const QModelIndex &index, int role) const
     return QVariant();
 }
 
-bool ListingItemModel::isItemAllowed(const REDasm::ListingItem *item) const
+ListingIndex::View ListingItemModel::indexView() const { return { m_itemtype, REDasm::SymbolType::None, false }; }
+bool ListingItemModel::isIndexView(ListingIndex::ViewMask views) const { return (m_indexview != -1) && (views & (static_cast<ListingIndex::ViewMask>(1) << m_indexview)); }
+
+void ListingItemModel::onBatchReady(int view, const QVector<address_t> &addresses)
 {
-    if(m_itemtype == REDasm::ListingItem::AllItems)
-        return true;
+    if(view != m_indexview)
+        return;
+
+    if(!m_items.size() || (addresses.front() > m_items[m_items.size() - 1]))
+    {
+        this->insertItems(addresses);
+        return;
+    }
+
+    QVector<address_t> missing; // Live changes got here first
+
+    for(address_t address : addresses)
+    {
+        if(m_items.indexOf(address) == REDasm::npos)
+            missing.push_back(address);
+    }
 
-    return m_itemtype == item->type;
+    this->insertItems(missing);
 }
 
-void ListingItemModel::onListingChanged(const REDasm::ListingDocumentChanged *ldc)
+void ListingItemModel::onChangesReady(const QVector<ListingIndex::Change> &changes)
 {
-    if(!this->isItemAllowed(ldc->item))
-        return;
+    QHash<address_t, bool> net; // Last change wins
 
-    if(ldc->isRemoved())
+    for(const ListingIndex::Change& change : changes)
     {
-        int idx = static_cast<int>(m_items.indexOf(ldc->item->address));
-        this->beginRemoveRows(QModelIndex(), idx, idx);
-        m_items.eraseAt(static_cast<size_t>(idx));
-        this->endRemoveRows();
+        if(this->isIndexView(change.views))
+            net[change.address] = change.inserted;
     }
-    else if(ldc->isInserted())
+
+    QVector<address_t> inserted, removed;
+
+    for(auto it = net.begin(); it != net.end(); it++)
+    {
+        bool present = m_items.indexOf(it.key()) != REDasm::npos;
+
+        if(it.value() && !present)
+            inserted.push_back(it.key());
+        else if(!it.value() && present)
+            removed.push_back(it.key());
+    }
+
+    std::sort(inserted.begin(), inserted.end());
+    std::sort(removed.begin(), removed.end());
+
+    if((inserted.size() + removed.size()) <= LISTING_RESET_THRESHOLD)
+    {
+        this->removeItems(removed);
+        this->insertItems(inserted);
+        return;
+    }
+
+    this->beginResetModel(); // Cheaper than thousands of row notifications
+
+    for(auto it = removed.rbegin(); it != removed.rend(); it++)
+        m_items.eraseAt(m_items.indexOf(*it));
+
+    for(address_t address : inserted)
+        m_items.insert(address);
+
+    this->endResetModel();
+}
+
+void ListingItemModel::insertItems(const QVector<address_t> &addresses)
+{
+    for(int i = 0; i < addresses.size(); )
     {
-        int idx = static_cast<int>(m_items.insertionIndex(ldc->item->address));
-        this->beginInsertRows(QModelIndex(), idx, idx);
-        m_items.insert(ldc->item->address);
+        size_t pos = m_items.insertionIndex(addresses[i]);
+        int j = i + 1;
+
+        while((j < addresses.size()) && ((pos >= m_items.size()) || (addresses[j] < m_items[pos]))) // Same gap: contiguous rows
+            j++;
+
+        this->beginInsertRows(QModelIndex(), static_cast<int>(pos), static_cast<int>(pos) + (j - i) - 1);
+
+        for(int k = i; k < j; k++)
+            m_items.insert(addresses[k]);
+
         this->endInsertRows();
+        i = j;
+    }
+}
+
+void ListingItemModel::removeItems(const QVector<address_t> &addresses)
+{
+    for(int i = addresses.size() - 1; i >= 0; )
+    {
+        size_t last = m_items.indexOf(addresses[i]), first = last;
+        int j = i - 1;
+
+        while((j >= 0) && (first > 0) && (m_items[first - 1] == addresses[j])) // Adjacent rows
+        {
+            first--;
+            j--;
+        }
+
+        this->beginRemoveRows(QModelIndex(), static_cast<int>(first), static_cast<int>(last));
+
+        for(size_t k = last + 1; k-- > first; )
+            m_items.eraseAt(k);
+
+        this->endRemoveRows();
+        i = j;
     }
 }
@@ -2,7 +2,10 @@
 #define LISTINGITEMMODEL_H
 
 #include <QList>
+#include <QStringList>
 #include "disassemblermodel.h"
+#include "listingindex.h"
+#include "symbolnamecache.h"
 #include <redasm/disassembler/listing/listingdocument.h>
 
 class ListingItemModel : public DisassemblerModel
@@ -14,6 +17,9 @@ class ListingItemModel : public DisassemblerModel
         void setDisassembler(const REDasm::DisassemblerPtr &disassembler) override;
         const REDasm::ListingItem* item(const QModelIndex& index) const;
         address_location address(const QModelIndex& index) const;
+        QVector<address_t> addresses() const;
+        virtual QStringList filterTexts(const QVector<address_t>& addresses, int first, int last) const;
+        virtual QStringList searchNames(const QVector<address_t>& addresses, int first, int last) const;
 
     public:
         QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
@@ -23,14 +29,23 @@ class ListingItemModel : public DisassemblerModel
         QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
 
     protected:
-        virtual bool isItemAllowed(const REDasm::ListingItem *item) const;
+        virtual ListingIndex::View indexView() const;
 
     private slots:
-        void onListingChanged(const REDasm::ListingDocumentChanged *ldc);
+        void onBatchReady(int view, const QVector<address_t>& addresses);
+        void onChangesReady(const QVector<ListingIndex::Change>& changes);
+
+    private:
+        bool isIndexView(ListingIndex::ViewMask views) const;
+        void insertItems(const QVector<address_t>& addresses);
+        void removeItems(const QVector<address_t>& addresses);
 
     private:
         REDasm::sorted_container<address_t> m_items;
+        std::shared_ptr<ListingIndex> m_index;
+        std::shared_ptr<SymbolNameCache> m_names;
         size_t m_itemtype;
+        int m_indexview;
 
     friend class ListingFilterModel;
 };
@@ -3,19 +3,32 @@
 #include <redasm/disassembler/listing/listingdocument.h>
 #include <redasm/plugins/loader.h>
 #include "../themeprovider.h"
+#include <QtConcurrent>
 
-ReferencesModel::ReferencesModel(QObject *parent): DisassemblerModel(parent) { }
+#define REFERENCES_PAGE_SIZE 1024 // Records per batch and rows per fetch
+
+ReferencesModel::ReferencesModel(QObject *parent): DisassemblerModel(parent), m_rowcount(0), m_resolving(false), m_fetchpending(false), m_generation(0)
+{
+    qRegisterMetaType< QVector<ReferencesModel::Reference> >("QVector<ReferencesModel::Reference>");
+    connect(this, &ReferencesModel::referencesReady, this, &ReferencesModel::onReferencesReady, Qt::QueuedConnection);
+}
+
+ReferencesModel::~ReferencesModel() { this->cancelReferences(); }
 
 void ReferencesModel::setDisassembler(const REDasm::DisassemblerPtr &disassembler)
 {
+    this->cancelReferences();
     DisassemblerModel::setDisassembler(disassembler);
     m_printer = REDasm::PrinterPtr(disassembler->assembler()->createPrinter(disassembler.get()));
 }
 
 void ReferencesModel::clear()
 {
+    this->cancelReferences();
     this->beginResetModel();
     m_references.clear();
+    m_rowcount = 0;
+    m_resolving = m_fetchpending = false;
     this->endResetModel();
 }
 
@@ -24,46 +37,40 @@ void ReferencesModel::xref(address_t address)
     if(!m_disassembler || m_disassembler->busy())
         return;
 
-    this->beginResetModel();
-    m_references = m_disassembler->getReferences(address);
-    this->endResetModel();
+    this->clear();
+
+    REDasm::ListingDocument& document = m_disassembler->document();
+    REDasm::ListingItem* item = document->itemAt(document->cursor()->currentLine());
+    address_location currentaddress = item ? REDasm::make_location(item->address) : REDasm::invalid_location<address_t>(); // Directions are relative to the cursor
+
+    int generation = m_generation.load();
+    m_resolving = true;
+    m_future = QtConcurrent::run([=]() { this->resolveReferences(generation, address, currentaddress); });
 }
 
 QModelIndex ReferencesModel::index(int row, int column, const QModelIndex &) const
 {
-    if(row >= static_cast<int>(m_references.size()))
+    if((row < 0) || (row >= m_rowcount))
         return QModelIndex();
 
-    return this->createIndex(row, column, m_references[row]);
+    return this->createIndex(row, column, m_references[row].address);
 }
 
 QVariant ReferencesModel::data(const QModelIndex &index, int role) const
 {
-    if(!m_disassembler || m_disassembler->busy())
+    if(!m_disassembler || !index.isValid() || (index.row() >= m_rowcount))
         return QVariant();
 
-    auto& document = m_disassembler->document();
-    auto it = document->instructionItem(m_references[index.row()]);
-
-    if(it == document->end())
-        it = document->symbolItem(m_references[index.row()]);
-
-    if(it == document->end())
-        return QVariant();
+    const Reference& reference = m_references[index.row()];
 
     if(role == Qt::DisplayRole)
     {
         if(index.column() == 0)
-            return S_TO_QS(REDasm::hex((*it)->address, m_disassembler->assembler()->bits()));
+            return reference.addresstext;
         else if(index.column() == 1)
-            return this->direction((*it)->address);
+            return reference.direction;
         else if(index.column() == 2)
-        {
-            if((*it)->is(REDasm::ListingItem::InstructionItem))
-                return QString::fromStdString(REDasm::simplified(m_printer->out(document->instruction((*it)->address))));
-            else if((*it)->is(REDasm::ListingItem::SymbolItem))
-                return QString::fromStdString(document->symbol((*it)->address)->name);
-        }
+            return reference.text;
     }
     else if(role == Qt::ForegroundRole)
     {
@@ -72,25 +79,14 @@ QVariant ReferencesModel::data(const QModelIndex &index, int role) const
 
         if(index.column() == 2)
         {
-            if((*it)->is(REDasm::ListingItem::InstructionItem))
+            switch(reference.color)
             {
-                REDasm::InstructionPtr instruction = document->instruction((*it)->address);
-
-                if(!instruction->is(REDasm::InstructionType::Conditional))
-                    return THEME_VALUE("instruction_jmp_c");
-                else if(instruction->is(REDasm::InstructionType::Jump))
-                    return THEME_VALUE("instruction_jmp");
-                else if(instruction->is(REDasm::InstructionType::Call))
-                    return THEME_VALUE("instruction_call");
-            }
-            else if((*it)->is(REDasm::ListingItem::SymbolItem))
-            {
-                const REDasm::Symbol* symbol = document->symbol((*it)->address);
-
-                if(symbol->is(REDasm::SymbolType::Data))
-                    return THEME_VALUE("data_fg");
-                else if(symbol->is(REDasm::SymbolType::String))
-                    return THEME_VALUE("string_fg");
+                case ReferencesModel::JumpConditionalColor: return THEME_VALUE("instruction_jmp_c");
+                case ReferencesModel::JumpColor: return THEME_VALUE("instruction_jmp");
+                case ReferencesModel::CallColor: return THEME_VALUE("instruction_call");
+                case ReferencesModel::DataColor: return THEME_VALUE("data_fg");
+                case ReferencesModel::StringColor: return THEME_VALUE("string_fg");
+                default: break;
             }
         }
     }
@@ -113,22 +109,105 @@ QVariant ReferencesModel::headerData(int section, Qt::Orientation orientation, i
     return QVariant();
 }
 
-int ReferencesModel::rowCount(const QModelIndex &) const { return static_cast<int>(m_references.size()); }
+int ReferencesModel::rowCount(const QModelIndex &) const { return m_rowcount; }
 int ReferencesModel::columnCount(const QModelIndex &) const { return 3; }
+bool ReferencesModel::canFetchMore(const QModelIndex &parent) const { return !parent.isValid() && (m_resolving || (m_rowcount < m_references.size())); }
 
-QString ReferencesModel::direction(address_t address) const
+void ReferencesModel::fetchMore(const QModelIndex &parent)
 {
-    REDasm::ListingCursor* cur = m_disassembler->document()->cursor();
-    REDasm::ListingItem* item = m_disassembler->document()->itemAt(cur->currentLine());
+    if(parent.isValid())
+        return;
+
+    int count = std::min(REFERENCES_PAGE_SIZE, m_references.size() - m_rowcount);
+    m_fetchpending = (count <= 0); // Not resolved yet, inserted when the next page arrives
+
+    if(m_fetchpending)
+        return;
+
+    this->beginInsertRows(QModelIndex(), m_rowcount, m_rowcount + count - 1);
+    m_rowcount += count;
+    this->endInsertRows();
+}
+
+void ReferencesModel::onReferencesReady(int generation, const QVector<ReferencesModel::Reference> &references, bool finished)
+{
+    if(generation != m_generation.load())
+        return;
+
+    m_references += references;
+    m_resolving = !finished;
 
-    if(item)
+    if(!m_rowcount || m_fetchpending) // First page, or the view is waiting at the bottom
+        this->fetchMore(QModelIndex());
+}
+
+void ReferencesModel::resolveReferences(int generation, address_t address, const address_location& currentaddress)
+{
+    REDasm::ReferenceVector references = m_disassembler->getReferences(address);
+    QVector<Reference> page;
+
+    for(size_t i = 0; (i < references.size()) && (generation == m_generation.load()); i++)
+    {
+        page.push_back(this->resolveReference(references[i], currentaddress));
+
+        if(page.size() < REFERENCES_PAGE_SIZE)
+            continue;
+
+        emit referencesReady(generation, page, false);
+        page.clear();
+    }
+
+    if(generation == m_generation.load())
+        emit referencesReady(generation, page, true);
+}
+
+ReferencesModel::Reference ReferencesModel::resolveReference(address_t address, const address_location& currentaddress) const
+{
+    auto lock = REDasm::s_lock_safe_ptr(m_disassembler->document());
+    Reference reference = { address, S_TO_QS(REDasm::hex(address, m_disassembler->assembler()->bits())), "---", QString(), ReferencesModel::NoColor };
+
+    if(currentaddress.valid)
     {
-        if(address > item->address)
-            return "Down";
+        if(address > currentaddress)
+            reference.direction = "Down";
+        else if(address < currentaddress)
+            reference.direction = "Up";
+    }
+
+    auto it = lock->instructionItem(address);
+
+    if(it != lock->end())
+    {
+        REDasm::InstructionPtr instruction = lock->instruction(address);
+        reference.text = QString::fromStdString(REDasm::simplified(m_printer->out(instruction)));
 
-        if(address < item->address)
-            return "Up";
+        if(!instruction->is(REDasm::InstructionType::Conditional))
+            reference.color = ReferencesModel::JumpConditionalColor;
+        else if(instruction->is(REDasm::InstructionType::Jump))
+            reference.color = ReferencesModel::JumpColor;
+        else if(instruction->is(REDasm::InstructionType::Call))
+            reference.color = ReferencesModel::CallColor;
+
+        return reference;
     }
 
-    return "---";
+    const REDasm::Symbol* symbol = (lock->symbolItem(address) != lock->end()) ? lock->symbol(address) : nullptr;
+
+    if(symbol)
+    {
+        reference.text = QString::fromStdString(symbol->name);
+
+        if(symbol->is(REDasm::SymbolType::Data))
+            reference.color = ReferencesModel::DataColor;
+        else if(symbol->is(REDasm::SymbolType::String))
+            reference.color = ReferencesModel::StringColor;
+    }
+
+    return reference;
+}
+
+void ReferencesModel::cancelReferences()
+{
+    m_generation.fetchAndAddOrdered(1);
+    m_future.waitForFinished();
 }
@@ -2,6 +2,8 @@
 #define REFERENCESMODEL_H
 
 #include <QJsonObject>
+#include <QAtomicInt>
+#include <QFuture>
 #include <redasm/plugins/assembler/printer.h>
 #include "disassemblermodel.h"
 
@@ -9,8 +11,19 @@ class ReferencesModel : public DisassemblerModel
 {
     Q_OBJECT
 
+    public:
+        enum { NoColor = 0, JumpConditionalColor, JumpColor, CallColor, DataColor, StringColor };
+
+        struct Reference
+        {
+            address_t address;
+            QString addresstext, direction, text;
+            int color;
+        };
+
     public:
         explicit ReferencesModel(QObject *parent = 0);
+        ~ReferencesModel();
         void setDisassembler(const REDasm::DisassemblerPtr& disassembler) override;
         void xref(address_t address);
 
@@ -20,16 +33,32 @@ class ReferencesModel : public DisassemblerModel
         QVariant headerData(int section, Qt::Orientation orientation, int role) const override;
         int rowCount(const QModelIndex&) const override;
         int columnCount(const QModelIndex&) const override;
+        bool canFetchMore(const QModelIndex& parent) const override;
+        void fetchMore(const QModelIndex& parent) override;
 
     public slots:
         void clear();
 
+    private slots:
+        void onReferencesReady(int generation, const QVector<ReferencesModel::Reference>& references, bool finished);
+
     private:
-        QString direction(address_t address) const;
+        void resolveReferences(int generation, address_t address, const address_location& currentaddress);
+        Reference resolveReference(address_t address, const address_location& currentaddress) const;
+        void cancelReferences();
+
+    signals:
+        void referencesReady(int generation, const QVector<ReferencesModel::Reference>& references, bool finished);
 
     private:
-        REDasm::ReferenceVector m_references;
+        QVector<Reference> m_references; // Resolved by the worker...
+        int m_rowcount;                  // ...and paged in by the view
+        bool m_resolving, m_fetchpending;
         REDasm::PrinterPtr m_printer;
+        QAtomicInt m_generation;
+        QFuture<void> m_future;
 };
 
+Q_DECLARE_METATYPE(ReferencesModel::Reference)
+
 #endif // REFERENCESMODEL_H
@@ -54,6 +54,43 @@ QVariant SegmentsModel::data(const QModelIndex &index, int role) const
     return QVariant();
 }
 
+QStringList SegmentsModel::filterTexts(const QVector<address_t> &addresses, int first, int last) const
+{
+    QStringList texts;
+    int bits = m_disassembler->assembler()->bits();
+    auto lock = REDasm::s_lock_safe_ptr(m_disassembler->document());
+
+    for(int i = first; i < last; i++)
+    {
+        const REDasm::Segment* segment = lock->segment(addresses[i]);
+        texts.push_back(segment ? SegmentsModel::segmentText(segment, bits) : QString());
+    }
+
+    return texts;
+}
+
+QStringList SegmentsModel::searchNames(const QVector<address_t> &addresses, int first, int last) const
+{
+    QStringList names;
+    auto lock = REDasm::s_lock_safe_ptr(m_disassembler->document());
+
+    for(int i = first; i < last; i++)
+    {
+        const REDasm::Segment* segment = lock->segment(addresses[i]);
+        names.push_back(segment ? S_TO_QS(segment->name) : QString());
+    }
+
+    return names;
+}
+
+QString SegmentsModel::segmentText(const REDasm::Segment *segment, int bits)
+{
+    return QStringList({ S_TO_QS(REDasm::hex(segment->address, bits)), S_TO_QS(REDasm::hex(segment->endaddress, bits)),
+                         S_TO_QS(REDasm::hex(segment->size(), bits)), S_TO_QS(REDasm::hex(segment->offset, bits)),
+                         S_TO_QS(REDasm::hex(segment->endoffset, bits)), S_TO_QS(REDasm::hex(segment->rawSize(), bits)),
+                         S_TO_QS(segment->name), SegmentsModel::segmentFlags(segment) }).join("\n");
+}
+
 QVariant SegmentsModel::headerData(int section, Qt::Orientation orientation, int role) const
 {
     if(orientation == Qt::Vertical || role != Qt::DisplayRole)
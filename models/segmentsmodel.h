@@ -14,6 +14,11 @@ class SegmentsModel : public ListingItemModel
         QVariant data(const QModelIndex &index, int role) const override;
         QVariant headerData(int section, Qt::Orientation orientation, int role) const override;
         int columnCount(const QModelIndex&) const override;
+        QStringList filterTexts(const QVector<address_t>& addresses, int first, int last) const override;
+        QStringList searchNames(const QVector<address_t>& addresses, int first, int last) const override;
+
+    public:
+        static QString segmentText(const REDasm::Segment* segment, int bits); // Searchable columns
 
     private:
         static QString segmentFlags(const REDasm::Segment* segment);
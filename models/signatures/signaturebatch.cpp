@@ -0,0 +1,87 @@
+#include "signaturebatch.h"
+#include "../../workchunks.h"
+#include <redasm/disassembler/listing/listingdocument.h>
+#include <QElapsedTimer>
+#include <QtConcurrent>
+#include <algorithm>
+
+#define SIGNATUREBATCH_CHUNK_SIZE 4096 // Functions per worker
+
+SignatureBatch::SignatureBatch(REDasm::DisassemblerAPI *disassembler): m_disassembler(disassembler), m_stop(false) { }
+
+QVector<SignatureBatch::Result> SignatureBatch::apply(QVector<Signature> signatures, const ProgressCallback &cb)
+{
+    std::sort(signatures.begin(), signatures.end(), [](const Signature& s1, const Signature& s2) -> bool { return s1.id < s2.id; });
+
+    QVector<Result> results;
+    QSet<address_t> locked = this->lockedFunctions();
+
+    for(int i = 0; !m_stop && (i < signatures.size()); i++)
+    {
+        if(cb)
+            cb(i, signatures.size());
+
+        QElapsedTimer timer;
+        timer.start();
+
+        Result result = { signatures[i].id, 0, 0, m_disassembler->loadSignature(signatures[i].path.toStdString()) };
+
+        if(result.ok)
+        {
+            QSet<address_t> nowlocked = this->lockedFunctions();
+            result.hits = (nowlocked - locked).size();
+            locked.swap(nowlocked);
+        }
+
+        result.elapsed = timer.elapsed();
+        results.push_back(result);
+    }
+
+    if(cb)
+        cb(signatures.size(), signatures.size());
+
+    return results;
+}
+
+void SignatureBatch::stop() { m_stop = true; }
+
+QString SignatureBatch::report(const QVector<Result> &results)
+{
+    QStringList lines;
+
+    for(const Result& result : results)
+    {
+        if(result.ok)
+            lines.push_back(QString("%1: %2 hit(s) in %3 ms").arg(result.id).arg(result.hits).arg(result.elapsed));
+        else
+            lines.push_back(QString("%1: failed").arg(result.id));
+    }
+
+    return lines.join("\n");
+}
+
+QSet<address_t> SignatureBatch::lockedFunctions() const
+{
+    auto lock = REDasm::s_lock_safe_ptr(m_disassembler->document());
+    QVector<address_t> functions;
+
+    for(const REDasm::ListingItem* item : lock->functions())
+        functions.push_back(item->address);
+
+    auto chunks = workChunks<int>(0, functions.size(), SIGNATUREBATCH_CHUNK_SIZE);
+
+    // Writers are blocked by 'lock' while the workers read the symbols
+    return QtConcurrent::blockingMappedReduced< QSet<address_t> >(chunks, [&](const QPair<int, int>& chunk) -> QSet<address_t> {
+        QSet<address_t> locked;
+
+        for(int i = chunk.first; i < chunk.second; i++)
+        {
+            const REDasm::Symbol* symbol = lock->symbol(functions[i]);
+
+            if(symbol && symbol->isLocked())
+                locked.insert(functions[i]);
+        }
+
+        return locked;
+    }, [](QSet<address_t>& result, const QSet<address_t>& locked) { result.unite(locked); });
+}
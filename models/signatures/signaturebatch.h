@@ -0,0 +1,37 @@
+#ifndef SIGNATUREBATCH_H
+#define SIGNATUREBATCH_H
+
+#include <QVector>
+#include <QString>
+#include <QSet>
+#include <functional>
+#include <atomic>
+#include <redasm/disassembler/disassemblerapi.h>
+
+// Applies several signature DBs in one go and reports what each of them named.
+// DBs are applied in signature id order: a function named (and locked) by a DB is skipped by the next ones,
+// so overlapping DBs always resolve the same way.
+class SignatureBatch
+{
+    public:
+        struct Signature { QString id, path; };
+        struct Result { QString id; int hits; qint64 elapsed; bool ok; };
+        typedef std::function<void(int, int)> ProgressCallback;
+
+    public:
+        explicit SignatureBatch(REDasm::DisassemblerAPI* disassembler);
+        QVector<Result> apply(QVector<Signature> signatures, const ProgressCallback& cb = nullptr);
+        void stop();
+
+    public:
+        static QString report(const QVector<Result>& results);
+
+    private:
+        QSet<address_t> lockedFunctions() const;
+
+    private:
+        REDasm::DisassemblerAPI* m_disassembler;
+        std::atomic<bool> m_stop;
+};
+
+#endif // SIGNATUREBATCH_H
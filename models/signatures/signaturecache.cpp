@@ -0,0 +1,204 @@
+#include "signaturecache.h"
+#include <redasm/database/signaturedb.h>
+#include <redasm/support/demangler.h>
+#include <QCryptographicHash>
+#include <QStandardPaths>
+#include <QDataStream>
+#include <QSaveFile>
+#include <QtEndian>
+#include <QDir>
+#include <algorithm>
+#include <cstring>
+
+#define SIGNATURECACHE_MAGIC      "RDSC"
+#define SIGNATURECACHE_VERSION    1
+#define SIGNATURECACHE_HEADER     16
+#define SIGNATURECACHE_HASH_BLOCK (1024 * 1024)
+#define SIGNATURECACHE_PROGRESS   4096 // Signatures per progress update
+
+SignatureCache::SignatureCache(): m_data(nullptr), m_size(0), m_count(0), m_assemblerlength(0) { }
+
+SignatureCache::~SignatureCache()
+{
+    if(m_data)
+        m_file.unmap(const_cast<uchar*>(m_data));
+}
+
+bool SignatureCache::open(const QString &sigpath, const ProgressCallback &cb)
+{
+    m_hash = SignatureCache::fileHash(sigpath, cb);
+
+    if(m_hash.isEmpty())
+        return this->fail("Cannot read " + sigpath);
+
+    QString cachepath = SignatureCache::cachePath(m_hash);
+
+    if(this->map(cachepath)) // Seen before: no JSON parsing at all
+        return true;
+
+    if(!this->build(sigpath, cachepath, cb))
+        return false;
+
+    return this->map(cachepath) || this->fail("Cannot map " + cachepath);
+}
+
+const QByteArray &SignatureCache::hash() const { return m_hash; }
+QString SignatureCache::assembler() const { return QString::fromUtf8(reinterpret_cast<const char*>(m_data + SIGNATURECACHE_HEADER), static_cast<int>(m_assemblerlength)); }
+
+QString SignatureCache::name(int index) const
+{
+    const uchar* offsets = this->names() - ((m_count + 1) * sizeof(quint32));
+    quint32 start = qFromLittleEndian<quint32>(offsets + (index * sizeof(quint32)));
+    quint32 end = qFromLittleEndian<quint32>(offsets + ((index + 1) * sizeof(quint32)));
+    return QString::fromUtf8(reinterpret_cast<const char*>(this->names() + start), static_cast<int>(end - start));
+}
+
+quint32 SignatureCache::patternsCount(int index) const
+{
+    const uchar* patterns = this->names() - ((m_count + 1) * sizeof(quint32)) - (m_count * sizeof(quint32));
+    return qFromLittleEndian<quint32>(patterns + (index * sizeof(quint32)));
+}
+
+int SignatureCache::size() const { return static_cast<int>(m_count); }
+
+QByteArray SignatureCache::fileHash(const QString &filepath, const ProgressCallback &cb)
+{
+    QFile file(filepath);
+
+    if(!file.open(QFile::ReadOnly))
+        return QByteArray();
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+
+    while(!file.atEnd())
+    {
+        hash.addData(file.read(SIGNATURECACHE_HASH_BLOCK));
+
+        if(cb)
+            cb(static_cast<int>((file.pos() * 100) / std::max<qint64>(file.size(), 1)), 300); // Hashing is the first third
+    }
+
+    return hash.result().toHex();
+}
+
+QString SignatureCache::cachePath(const QByteArray &hash)
+{
+    QDir dir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation));
+    dir.mkpath("signatures");
+    return dir.filePath("signatures/" + QString::fromLatin1(hash) + ".rdsc");
+}
+
+bool SignatureCache::map(const QString &cachepath)
+{
+    m_file.setFileName(cachepath);
+
+    if(!m_file.open(QFile::ReadOnly) || (m_file.size() < SIGNATURECACHE_HEADER))
+        return false;
+
+    m_size = m_file.size();
+    m_data = m_file.map(0, m_size);
+
+    if(m_data && !memcmp(m_data, SIGNATURECACHE_MAGIC, 4) && (qFromLittleEndian<quint32>(m_data + 4) == SIGNATURECACHE_VERSION))
+    {
+        m_count = qFromLittleEndian<quint32>(m_data + 8);
+        m_assemblerlength = qFromLittleEndian<quint32>(m_data + 12);
+
+        quint64 tablesend = SIGNATURECACHE_HEADER + ((static_cast<quint64>(m_assemblerlength) + 3) & ~3ull) + ((2 * static_cast<quint64>(m_count) + 1) * sizeof(quint32));
+
+        // Truncated or damaged files are rebuilt
+        if((tablesend <= static_cast<quint64>(m_size)) && this->checkNameOffsets(static_cast<quint64>(m_size) - tablesend))
+            return true;
+    }
+
+    if(m_data)
+        m_file.unmap(const_cast<uchar*>(m_data));
+
+    m_data = nullptr;
+    m_count = m_assemblerlength = 0;
+    m_file.close();
+    return false;
+}
+
+bool SignatureCache::checkNameOffsets(quint64 namessize) const
+{
+    const uchar* offsets = this->names() - ((m_count + 1) * sizeof(quint32));
+    quint32 last = 0;
+
+    // name() reads [offsets[i], offsets[i + 1]): they must grow and stay in the file
+    for(quint32 i = 0; i <= m_count; i++)
+    {
+        quint32 offset = qFromLittleEndian<quint32>(offsets + (i * sizeof(quint32)));
+
+        if((offset < last) || (offset > namessize))
+            return false;
+
+        last = offset;
+    }
+
+    return true;
+}
+
+bool SignatureCache::build(const QString &sigpath, const QString &cachepath, const ProgressCallback &cb)
+{
+    REDasm::SignatureDB sigdb;
+
+    if(cb)
+        cb(100, 300);
+
+    if(!sigdb.load(sigpath.toStdString()))
+        return this->fail("Cannot load " + sigpath);
+
+    QByteArray assembler = QString::fromStdString(sigdb.assembler()).toUtf8(), names;
+    QVector<quint32> patterns, nameoffsets;
+    patterns.reserve(static_cast<int>(sigdb.size()));
+    nameoffsets.reserve(static_cast<int>(sigdb.size()) + 1);
+
+    for(size_t i = 0; i < sigdb.size(); i++)
+    {
+        const auto& signature = sigdb.at(i);
+        nameoffsets.push_back(static_cast<quint32>(names.size()));
+        names += QString::fromStdString(REDasm::Demangler::demangled(signature["name"])).toUtf8();
+        patterns.push_back(static_cast<quint32>(signature["patterns"].size()));
+
+        if(cb && !(i % SIGNATURECACHE_PROGRESS))
+            cb(200 + static_cast<int>((i * 100) / sigdb.size()), 300);
+    }
+
+    nameoffsets.push_back(static_cast<quint32>(names.size()));
+
+    QSaveFile file(cachepath);
+
+    if(!file.open(QFile::WriteOnly))
+        return this->fail("Cannot write " + cachepath + ": " + file.errorString());
+
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.writeRawData(SIGNATURECACHE_MAGIC, 4);
+    stream << static_cast<quint32>(SIGNATURECACHE_VERSION) << static_cast<quint32>(patterns.size()) << static_cast<quint32>(assembler.size());
+    stream.writeRawData(assembler.constData(), assembler.size());
+
+    for(int i = assembler.size(); i % 4; i++)
+        stream << static_cast<quint8>(0);
+
+    for(quint32 count : patterns)
+        stream << count;
+
+    for(quint32 offset : nameoffsets)
+        stream << offset;
+
+    stream.writeRawData(names.constData(), names.size());
+
+    if((stream.status() != QDataStream::Ok) || !file.commit())
+        return this->fail("Cannot write " + cachepath + ": " + file.errorString());
+
+    if(cb)
+        cb(300, 300);
+
+    return true;
+}
+
+const uchar *SignatureCache::names() const
+{
+    quint32 assemblerlength = (m_assemblerlength + 3) & ~3u;
+    return m_data + SIGNATURECACHE_HEADER + assemblerlength + (m_count * sizeof(quint32)) + ((m_count + 1) * sizeof(quint32));
+}
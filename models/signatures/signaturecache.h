@@ -0,0 +1,54 @@
+#ifndef SIGNATURECACHE_H
+#define SIGNATURECACHE_H
+
+#include <QByteArray>
+#include <QString>
+#include <QFile>
+#include <functional>
+#include <memory>
+#include "../../lasterror.h"
+
+// Browsing view of a signature DB: the JSON file is parsed once and converted to a compact binary file,
+// keyed by the JSON's hash, that later loads just map in memory.
+//
+// Layout (little endian):
+//   Header  { magic "RDSC", version, count, assembler length }
+//   char    assembler[assembler length], padded to 4 bytes
+//   quint32 patterns[count]
+//   quint32 nameoffsets[count + 1]  (relative to 'names')
+//   char    names[]                 (demangled, UTF-8)
+class SignatureCache : public LastError
+{
+    public:
+        typedef std::function<void(int, int)> ProgressCallback;
+        typedef std::shared_ptr<const SignatureCache> Ptr;
+
+    public:
+        SignatureCache();
+        ~SignatureCache();
+        bool open(const QString& sigpath, const ProgressCallback& cb = nullptr);
+        const QByteArray& hash() const;
+        QString assembler() const;
+        QString name(int index) const;
+        quint32 patternsCount(int index) const;
+        int size() const;
+
+    public:
+        static QByteArray fileHash(const QString& filepath, const ProgressCallback& cb = nullptr);
+        static QString cachePath(const QByteArray& hash);
+
+    private:
+        bool map(const QString& cachepath);
+        bool checkNameOffsets(quint64 namessize) const;
+        bool build(const QString& sigpath, const QString& cachepath, const ProgressCallback& cb);
+        const uchar* names() const;
+
+    private:
+        QFile m_file;
+        const uchar* m_data;
+        qint64 m_size;
+        quint32 m_count, m_assemblerlength;
+        QByteArray m_hash;
+};
+
+#endif // SIGNATURECACHE_H
@@ -2,10 +2,14 @@
 #include <redasm/redasm.h>
 #include <QFileInfo>
 #include <QDirIterator>
+#include <QtConcurrent>
 #include <QDir>
 
 SignatureFilesModel::SignatureFilesModel(REDasm::DisassemblerAPI *disassembler, QObject *parent): QAbstractListModel(parent), m_disassembler(disassembler)
 {
+    qRegisterMetaType<SignatureCache::Ptr>("SignatureCache::Ptr");
+    connect(this, &SignatureFilesModel::signatureReady, this, &SignatureFilesModel::onSignatureReady, Qt::QueuedConnection);
+
     QDirIterator it(QString::fromStdString(REDasm::makeSignaturePath(std::string())), {"*.json"}, QDir::Files);
 
     while(it.hasNext())
@@ -16,16 +20,30 @@ SignatureFilesModel::SignatureFilesModel(REDasm::DisassemblerAPI *disassembler,
     }
 }
 
-const REDasm::SignatureDB *SignatureFilesModel::load(const QModelIndex &index)
+SignatureFilesModel::~SignatureFilesModel()
 {
-    if(!m_loadedsignatures.contains(index.row()))
-    {
-        REDasm::SignatureDB sigdb;
-        sigdb.load(m_signaturefiles[index.row()].second);
-        m_loadedsignatures[index.row()] = sigdb;
-    }
+    for(QFuture<void>& future : m_futures)
+        future.waitForFinished();
+}
+
+SignatureCache::Ptr SignatureFilesModel::signature(const QModelIndex &index) const { return m_loadedsignatures.value(index.row()); }
+
+void SignatureFilesModel::load(const QModelIndex &index)
+{
+    int row = index.row();
+
+    if(m_loadedsignatures.contains(row) || m_loading.contains(row))
+        return;
+
+    QString sigpath = QString::fromStdString(m_signaturefiles[row].second);
+    m_loading.insert(row);
+
+    m_futures.push_back(QtConcurrent::run([=]() {
+        auto signature = std::make_shared<SignatureCache>();
 
-    return &m_loadedsignatures[index.row()];
+        bool ok = signature->open(sigpath, [&](int value, int maximum) { emit loadProgress(row, value, maximum); });
+        emit signatureReady(row, ok ? signature : nullptr, signature->lastError());
+    }));
 }
 
 const std::string &SignatureFilesModel::signatureId(const QModelIndex &index) const { return m_signaturefiles[index.row()].first;  }
@@ -89,5 +107,27 @@ QVariant SignatureFilesModel::headerData(int section, Qt::Orientation orientatio
     return QVariant();
 }
 
+void SignatureFilesModel::onSignatureReady(int row, const SignatureCache::Ptr &signature, const QString &error)
+{
+    m_loading.remove(row);
+
+    for(auto it = m_futures.begin(); it != m_futures.end(); )
+    {
+        if(it->isFinished())
+            it = m_futures.erase(it);
+        else
+            it++;
+    }
+
+    if(!signature)
+    {
+        emit signatureFailed(row, error);
+        return;
+    }
+
+    m_loadedsignatures[row] = signature;
+    emit signatureLoaded(row);
+}
+
 int SignatureFilesModel::rowCount(const QModelIndex &) const { return m_signaturefiles.length(); }
 int SignatureFilesModel::columnCount(const QModelIndex&) const { return 2; }
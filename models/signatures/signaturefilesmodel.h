@@ -2,10 +2,13 @@
 #define SIGNATUREFILESMODEL_H
 
 #include <QAbstractListModel>
+#include <QFuture>
+#include <QSet>
 #include <redasm/disassembler/disassemblerapi.h>
 #include <redasm/database/signaturedb.h>
 #include <redasm/plugins/loader.h>
 #include <json.hpp>
+#include "signaturecache.h"
 
 class SignatureFilesModel : public QAbstractListModel
 {
@@ -13,7 +16,9 @@ class SignatureFilesModel : public QAbstractListModel
 
     public:
         explicit SignatureFilesModel(REDasm::DisassemblerAPI* disassembler, QObject *parent = nullptr);
-        const REDasm::SignatureDB* load(const QModelIndex& index);
+        ~SignatureFilesModel();
+        SignatureCache::Ptr signature(const QModelIndex& index) const;
+        void load(const QModelIndex& index);
         const std::string& signatureId(const QModelIndex& index) const;
         const std::string& signaturePath(const QModelIndex& index) const;
         bool isLoaded(const QModelIndex& index) const;
@@ -27,9 +32,20 @@ class SignatureFilesModel : public QAbstractListModel
         int rowCount(const QModelIndex& = QModelIndex()) const override;
         int columnCount(const QModelIndex& = QModelIndex()) const override;
 
+    private slots:
+        void onSignatureReady(int row, const SignatureCache::Ptr& signature, const QString& error);
+
+    signals:
+        void loadProgress(int row, int value, int maximum);
+        void signatureReady(int row, const SignatureCache::Ptr& signature, const QString& error);
+        void signatureLoaded(int row);
+        void signatureFailed(int row, const QString& error);
+
     private:
         QList< QPair<std::string, std::string> > m_signaturefiles;
-        QHash<int, REDasm::SignatureDB> m_loadedsignatures;
+        QHash<int, SignatureCache::Ptr> m_loadedsignatures;
+        QSet<int> m_loading;
+        QList< QFuture<void> > m_futures;
         REDasm::DisassemblerAPI* m_disassembler;
 };
 
@@ -0,0 +1,265 @@
+#include "signaturegenerator.h"
+#include "../../workchunks.h"
+#include "signaturecache.h"
+#include <redasm/disassembler/listing/listingdocument.h>
+#include <QtConcurrent>
+#include <algorithm>
+#include <cstring>
+
+#define SIGNATUREGENERATOR_CHUNK_SIZE  64  // Functions per worker
+#define SIGNATUREGENERATOR_MAX_SIZE    256 // Pattern bytes taken from the start of a function
+#define SIGNATUREGENERATOR_MIN_SIZE    8   // Shorter functions would match everywhere
+#define SIGNATUREGENERATOR_MIN_PATTERN 2   // Shorter runs are left out too
+
+SignatureGenerator::SignatureGenerator(REDasm::DisassemblerAPI *disassembler): m_disassembler(disassembler), m_count(0), m_stop(false) { }
+
+bool SignatureGenerator::generate(const QVector<address_t> &functions, const QString &name, const QString &sigpath, const ProgressCallback &cb)
+{
+    m_count = 0;
+
+    auto chunks = workChunks<int>(0, functions.size(), SIGNATUREGENERATOR_CHUNK_SIZE);
+
+    QAtomicInt done(0);
+
+    // The document is locked by each extraction: workers must not run under a lock held here
+    auto results = QtConcurrent::blockingMapped< QVector< QVector<Signature> > >(chunks, [&](const QPair<int, int>& chunk) -> QVector<Signature> {
+        QVector<Signature> signatures;
+
+        for(int i = chunk.first; !m_stop && (i < chunk.second); i++)
+        {
+            Signature signature;
+
+            if(this->extract(functions[i], &signature))
+                signatures.push_back(signature);
+        }
+
+        if(cb)
+            cb(done.fetchAndAddOrdered(chunk.second - chunk.first) + (chunk.second - chunk.first), functions.size() + 1);
+
+        return signatures;
+    });
+
+    if(m_stop)
+        return this->fail("Generation stopped");
+
+    REDasm::SignatureDB sigdb;
+    sigdb.setName(name.toStdString());
+    sigdb.setAssembler(m_disassembler->loader()->assembler());
+
+    QVector<Signature> signatures;
+
+    for(const auto& result : results) // Chunks keep the order of 'functions'
+        signatures += result;
+
+    for(const Signature& signature : signatures)
+    {
+        auto patterns = nlohmann::json::array();
+
+        for(const Pattern& pattern : signature.patterns)
+            patterns.push_back({ { "offset", pattern.offset }, { "size", pattern.bytes.size() }, { "hex", pattern.bytes.toHex().toStdString() } });
+
+        sigdb << nlohmann::json({ { "name", signature.name.toStdString() }, { "size", signature.size },
+                                  { "symboltype", signature.symboltype }, { "patterns", patterns } });
+        m_count++;
+    }
+
+    if(!m_count)
+        return this->fail("No function has enough bytes to be signed");
+
+    if(!sigdb.save(sigpath.toStdString()))
+        return this->fail("Cannot write " + sigpath);
+
+    if(!this->verify(sigpath, signatures))
+        return false;
+
+    SignatureCache cache; // Later loads just map it
+
+    if(!cache.open(sigpath))
+        return this->fail(cache.lastError());
+
+    if(cb)
+        cb(functions.size() + 1, functions.size() + 1);
+
+    return true;
+}
+
+int SignatureGenerator::count() const { return m_count; }
+void SignatureGenerator::stop() { m_stop = true; }
+
+QVector<address_t> SignatureGenerator::namedFunctions(REDasm::DisassemblerAPI *disassembler)
+{
+    auto lock = REDasm::s_lock_safe_ptr(disassembler->document());
+    QVector<address_t> functions;
+
+    for(const REDasm::ListingItem* item : lock->functions())
+    {
+        const REDasm::Symbol* symbol = lock->symbol(item->address);
+
+        if(symbol && symbol->isLocked()) // Names from debug info, exports and signatures
+            functions.push_back(item->address);
+    }
+
+    return functions;
+}
+
+bool SignatureGenerator::extract(address_t address, Signature *signature) const
+{
+    QVector<Span> spans = this->spans(address, signature);
+
+    if(spans.empty())
+        return false;
+
+    REDasm::AbstractBuffer* buffer = m_disassembler->loader()->buffer();
+    Pattern pattern = { 0, QByteArray() };
+    signature->address = address;
+    signature->size = 0;
+
+    for(const Span& span : spans) // The matcher compares the size of the whole function
+        signature->size = std::max<u64>(signature->size, (span.address - address) + span.size);
+
+    for(const Span& span : spans)
+    {
+        u64 offset = span.address - address;
+
+        if(offset >= SIGNATUREGENERATOR_MAX_SIZE)
+            break;
+
+        offset_location location = m_disassembler->loader()->offset(span.address);
+        u64 size = std::min<u64>(span.size, SIGNATUREGENERATOR_MAX_SIZE - offset);
+
+        if(!location.valid || ((static_cast<u64>(location) + size) > buffer->size()))
+            break;
+
+        // Operands are relocated and the opcode layout depends on the assembler: the whole instruction is left out
+        if(span.masked || (!pattern.bytes.isEmpty() && ((pattern.offset + pattern.bytes.size()) != offset)))
+        {
+            if(pattern.bytes.size() >= SIGNATUREGENERATOR_MIN_PATTERN)
+                signature->patterns.push_back(pattern);
+
+            pattern.bytes.clear();
+
+            if(span.masked)
+                continue;
+        }
+
+        if(pattern.bytes.isEmpty())
+            pattern.offset = offset;
+
+        pattern.bytes.append(reinterpret_cast<const char*>(buffer->data()) + static_cast<u64>(location), static_cast<int>(size));
+    }
+
+    if(pattern.bytes.size() >= SIGNATUREGENERATOR_MIN_PATTERN)
+        signature->patterns.push_back(pattern);
+
+    return !signature->patterns.empty() && (signature->size >= SIGNATUREGENERATOR_MIN_SIZE);
+}
+
+bool SignatureGenerator::verify(const QString &sigpath, const QVector<Signature> &signatures)
+{
+    REDasm::SignatureDB sigdb;
+
+    if(!sigdb.load(sigpath.toStdString()))
+        return this->fail("Cannot load " + sigpath);
+
+    if(sigdb.size() != static_cast<size_t>(signatures.size()))
+        return this->fail(QString("%1 has %2 signature(s), %3 were written").arg(sigpath).arg(sigdb.size()).arg(signatures.size()));
+
+    int missed = 0;
+
+    for(size_t i = 0; i < sigdb.size(); i++) // Entries keep the order they were written in
+    {
+        if(!this->matches(signatures[static_cast<int>(i)], sigdb.at(i)))
+            missed++;
+    }
+
+    if(missed)
+        return this->fail(QString("%1 of %2 signature(s) don't match the function they were built from").arg(missed).arg(signatures.size()));
+
+    return true;
+}
+
+bool SignatureGenerator::matches(const Signature &signature, const nlohmann::json &entry) const
+{
+    // Same checks as the library's matcher: name, symbol type, function size and pattern bytes
+    if((entry["name"].get<std::string>() != signature.name.toStdString()) || (entry["symboltype"].get<u32>() != signature.symboltype) ||
+       (entry["size"].get<u64>() != signature.size) || entry["patterns"].empty())
+        return false;
+
+    REDasm::AbstractBuffer* buffer = m_disassembler->loader()->buffer();
+
+    for(const auto& pattern : entry["patterns"])
+    {
+        QByteArray bytes = QByteArray::fromHex(QByteArray::fromStdString(pattern["hex"].get<std::string>()));
+        u64 offset = pattern["offset"].get<u64>();
+
+        if((static_cast<u64>(bytes.size()) != pattern["size"].get<u64>()) || ((offset + bytes.size()) > signature.size))
+            return false;
+
+        offset_location location = m_disassembler->loader()->offset(signature.address + offset);
+
+        if(!location.valid || ((static_cast<u64>(location) + bytes.size()) > buffer->size()))
+            return false;
+
+        if(memcmp(buffer->data() + static_cast<u64>(location), bytes.constData(), static_cast<size_t>(bytes.size())))
+            return false;
+    }
+
+    return true;
+}
+
+QVector<SignatureGenerator::Span> SignatureGenerator::spans(address_t address, Signature *signature) const
+{
+    QVector<Span> spans;
+    QVector<REDasm::InstructionPtr> instructions;
+
+    {
+        auto lock = REDasm::s_lock_safe_ptr(m_disassembler->document());
+        const REDasm::Symbol* symbol = lock->symbol(address);
+        const REDasm::ListingItem* item = lock->functionStart(address);
+
+        if(!symbol || !item)
+            return spans;
+
+        const REDasm::Graphing::FunctionGraph* g = lock->functions().graph(item);
+
+        if(!g)
+            return spans;
+
+        signature->name = QString::fromStdString(symbol->name); // Mangled, as the loader reads it
+        signature->symboltype = static_cast<u32>(symbol->type);
+
+        for(const auto& n : g->nodes())
+        {
+            const REDasm::Graphing::FunctionBasicBlock* fbb = g->data(n);
+
+            if(!fbb)
+                continue;
+
+            for(size_t i = fbb->startidx; i <= fbb->endidx; i++)
+            {
+                const REDasm::ListingItem* blockitem = lock->itemAt(i);
+
+                if(!blockitem->is(REDasm::ListingItem::InstructionItem) || (blockitem->address < address))
+                    continue;
+
+                REDasm::InstructionPtr instruction = lock->instruction(blockitem->address);
+
+                if(instruction)
+                    instructions.push_back(instruction);
+            }
+        }
+    }
+
+    for(const REDasm::InstructionPtr& instruction : instructions)
+    {
+        bool masked = m_disassembler->getTargetsCount(instruction->address) > 0;
+
+        for(const REDasm::Operand& op : instruction->operands)
+            masked |= op.is(REDasm::OperandType::Memory);
+
+        spans.push_back({ instruction->address, instruction->size, masked });
+    }
+
+    std::sort(spans.begin(), spans.end(), [](const Span& s1, const Span& s2) -> bool { return s1.address < s2.address; });
+    return spans;
+}
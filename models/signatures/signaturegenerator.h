@@ -0,0 +1,49 @@
+#ifndef SIGNATUREGENERATOR_H
+#define SIGNATUREGENERATOR_H
+
+#include <QVector>
+#include <QString>
+#include <functional>
+#include <atomic>
+#include <redasm/disassembler/disassemblerapi.h>
+#include <redasm/database/signaturedb.h>
+#include "../../lasterror.h"
+
+// Builds a signature DB from the functions of the current document.
+// Every function becomes a list of byte patterns taken from its first bytes: operands of instructions
+// that reference other addresses change between builds, so they are left out and split the patterns.
+// Entries carry what the library's matcher reads: the whole function size, the symbol type to lock the name with
+// and the patterns. The DB is written as JSON, read back and checked against the functions it was built from,
+// then its binary cache is built right away.
+class SignatureGenerator : public LastError
+{
+    public:
+        typedef std::function<void(int, int)> ProgressCallback;
+
+    public:
+        explicit SignatureGenerator(REDasm::DisassemblerAPI* disassembler);
+        bool generate(const QVector<address_t>& functions, const QString& name, const QString& sigpath, const ProgressCallback& cb = nullptr);
+        int count() const;
+        void stop();
+
+    public:
+        static QVector<address_t> namedFunctions(REDasm::DisassemblerAPI* disassembler);
+
+    private:
+        struct Span { address_t address; u64 size; bool masked; };
+        struct Pattern { u64 offset; QByteArray bytes; };
+        struct Signature { address_t address; QString name; u32 symboltype; u64 size; QVector<Pattern> patterns; };
+
+    private:
+        bool extract(address_t address, Signature* signature) const;
+        bool verify(const QString& sigpath, const QVector<Signature>& signatures);
+        bool matches(const Signature& signature, const nlohmann::json& entry) const;
+        QVector<Span> spans(address_t address, Signature* signature) const;
+
+    private:
+        REDasm::DisassemblerAPI* m_disassembler;
+        int m_count;
+        std::atomic<bool> m_stop;
+};
+
+#endif // SIGNATUREGENERATOR_H
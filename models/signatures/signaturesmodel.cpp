@@ -1,39 +1,28 @@
 #include "signaturesmodel.h"
-#include <redasm/support/demangler.h>
 
-SignaturesModel::SignaturesModel(QObject *parent): QAbstractListModel(parent), m_signaturedb(nullptr) { }
+SignaturesModel::SignaturesModel(QObject *parent): QAbstractListModel(parent) { }
 
-void SignaturesModel::setSignature(const REDasm::SignatureDB *sigdb)
+void SignaturesModel::setSignature(const SignatureCache::Ptr &signature)
 {
     this->beginResetModel();
-    m_signaturedb = sigdb;
+    m_signature = signature;
+    m_assembler = signature ? signature->assembler() : QString();
     this->endResetModel();
 }
 
 QVariant SignaturesModel::data(const QModelIndex &index, int role) const
 {
-    if(!m_signaturedb || (role != Qt::DisplayRole))
+    if(!m_signature || (role != Qt::DisplayRole))
         return QVariant();
 
     if(index.column() == 0)
-    {
-        const auto& signature = m_signaturedb->at(index.row());
-        return QString::fromStdString(REDasm::Demangler::demangled(signature["name"]));
-    }
+        return m_signature->name(index.row());
     if(index.column() == 1)
-        return QString::fromStdString(m_signaturedb->assembler());
+        return m_assembler;
     if(index.column() == 2)
-        return static_cast<quint64>(m_signaturedb->size());
+        return static_cast<quint64>(m_signature->size());
     if(index.column() == 3)
-    {
-        const auto& signature = m_signaturedb->at(index.row());
-        return static_cast<quint64>(signature["patterns"].size());
-    }
-    if(index.column() == 4)
-    {
-        const auto& signature = m_signaturedb->at(index.row());
-        return static_cast<quint64>(signature["patterns"]["symboltype"]);
-    }
+        return static_cast<quint64>(m_signature->patternsCount(index.row()));
 
     return QVariant();
 }
@@ -57,5 +46,5 @@ QVariant SignaturesModel::headerData(int section, Qt::Orientation orientation, i
     return QVariant();
 }
 
-int SignaturesModel::rowCount(const QModelIndex &) const { return m_signaturedb ? m_signaturedb->size() : 0; }
+int SignaturesModel::rowCount(const QModelIndex &) const { return m_signature ? m_signature->size() : 0; }
 int SignaturesModel::columnCount(const QModelIndex &) const { return 4; }
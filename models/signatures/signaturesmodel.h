@@ -2,7 +2,7 @@
 #define SIGNATURESMODEL_H
 
 #include <QAbstractListModel>
-#include <redasm/database/signaturedb.h>
+#include "signaturecache.h"
 
 class SignaturesModel : public QAbstractListModel
 {
@@ -10,7 +10,7 @@ class SignaturesModel : public QAbstractListModel
 
     public:
         explicit SignaturesModel(QObject *parent = nullptr);
-        void setSignature(const REDasm::SignatureDB* sigdb);
+        void setSignature(const SignatureCache::Ptr& signature);
 
     public:
         QVariant data(const QModelIndex &index, int role) const override;
@@ -19,7 +19,8 @@ class SignaturesModel : public QAbstractListModel
         int columnCount(const QModelIndex& = QModelIndex()) const override;
 
     private:
-        const REDasm::SignatureDB* m_signaturedb;
+        SignatureCache::Ptr m_signature;
+        QString m_assembler;
 };
 
 #endif // SIGNATURESMODEL_H
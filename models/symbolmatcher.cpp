@@ -0,0 +1,149 @@
+#include "symbolmatcher.h"
+#include <algorithm>
+
+#define FUZZY_PREFIX         '~'
+#define REGEX_PREFIX         '/'
+#define FUZZY_MATCH          16
+#define FUZZY_GAP_START      3
+#define FUZZY_GAP_EXTENSION  1
+#define FUZZY_BOUNDARY       8 // After a separator or at the start
+#define FUZZY_CAMEL          7 // lowerUpper and letter/digit transitions
+#define FUZZY_CONSECUTIVE    4
+#define RANK_BASE            1000
+
+static int boundaryBonus(const QString& text, int i)
+{
+    if(!i || !text[i - 1].isLetterOrNumber())
+        return FUZZY_BOUNDARY;
+
+    if((text[i - 1].isLower() && text[i].isUpper()) || (!text[i - 1].isDigit() && text[i].isDigit()))
+        return FUZZY_CAMEL;
+
+    return 0;
+}
+
+static inline bool matchChar(const QChar& t, const QChar& p) { return t.toLower() == p; }
+
+SymbolMatcher::SymbolMatcher(const QString &query): m_mode(SymbolMatcher::Substring)
+{
+    if(query.startsWith(FUZZY_PREFIX))
+    {
+        m_mode = SymbolMatcher::Fuzzy;
+        m_pattern = query.mid(1).toLower();
+    }
+    else if(query.startsWith(REGEX_PREFIX))
+    {
+        m_mode = SymbolMatcher::Regex;
+        m_pattern = query.mid(1);
+        m_regex = QRegularExpression(m_pattern, QRegularExpression::CaseInsensitiveOption);
+    }
+    else
+        m_pattern = query;
+}
+
+SymbolMatcher::Mode SymbolMatcher::mode() const { return m_mode; }
+const QString &SymbolMatcher::pattern() const { return m_pattern; }
+bool SymbolMatcher::isRanked() const { return m_mode != SymbolMatcher::Substring; }
+bool SymbolMatcher::isValid() const { return !m_pattern.isEmpty() && ((m_mode != SymbolMatcher::Regex) || m_regex.isValid()); }
+
+int SymbolMatcher::score(const QString &text) const
+{
+    if(m_mode == SymbolMatcher::Fuzzy)
+        return SymbolMatcher::fuzzyScore(m_pattern, text);
+
+    int start = -1;
+
+    if(m_mode == SymbolMatcher::Regex)
+    {
+        QRegularExpressionMatch match = m_regex.match(text);
+
+        if(match.hasMatch())
+            start = match.capturedStart();
+    }
+    else
+        start = text.indexOf(m_pattern, 0, Qt::CaseInsensitive);
+
+    if(start == -1)
+        return SYMBOLMATCHER_NOMATCH;
+
+    return std::max(0, RANK_BASE - (start * 4) - text.size()); // Early matches in short names first
+}
+
+int SymbolMatcher::fuzzyScore(const QString &pattern, const QString &text)
+{
+    int pidx = 0, start = -1, end = -1;
+
+    for(int i = 0; i < text.size(); i++) // Leftmost end of the subsequence...
+    {
+        if(!matchChar(text[i], pattern[pidx]) || (++pidx < pattern.size()))
+            continue;
+
+        end = i;
+        break;
+    }
+
+    if(end == -1)
+        return SYMBOLMATCHER_NOMATCH;
+
+    pidx = pattern.size() - 1;
+
+    for(int i = end; i >= 0; i--) // ...and the shortest window that ends there
+    {
+        if(!matchChar(text[i], pattern[pidx]) || (--pidx >= 0))
+            continue;
+
+        start = i;
+        break;
+    }
+
+    int score = 0, consecutive = 0;
+    bool gap = false;
+    pidx = 0;
+
+    for(int i = start; i <= end; i++)
+    {
+        if((pidx < pattern.size()) && matchChar(text[i], pattern[pidx]))
+        {
+            int bonus = boundaryBonus(text, i);
+
+            if(consecutive)
+                bonus = std::max(bonus, FUZZY_CONSECUTIVE);
+            if(!pidx)
+                bonus *= 2;
+
+            score += FUZZY_MATCH + bonus;
+            consecutive++;
+            gap = false;
+            pidx++;
+        }
+        else
+        {
+            score -= gap ? FUZZY_GAP_EXTENSION : FUZZY_GAP_START;
+            consecutive = 0;
+            gap = true;
+        }
+    }
+
+    return std::max(0, score);
+}
+
+void SymbolMatcher::mergeTop(QVector<SymbolMatcher::Match> &top, QVector<SymbolMatcher::Match> matches, int count)
+{
+    matches += top;
+
+    auto better = [](const Match& a, const Match& b) {
+        if(a.score != b.score)
+            return a.score > b.score;
+
+        return a.address < b.address;
+    };
+
+    if(matches.size() > count)
+    {
+        std::nth_element(matches.begin(), matches.begin() + count, matches.end(), better);
+        matches.resize(count);
+    }
+
+    std::sort(matches.begin(), matches.end(), better);
+    top.swap(matches);
+}
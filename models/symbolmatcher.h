@@ -0,0 +1,36 @@
+#ifndef SYMBOLMATCHER_H
+#define SYMBOLMATCHER_H
+
+#include <QRegularExpression>
+#include <QString>
+#include <QVector>
+#include <redasm/redasm.h>
+
+#define SYMBOLMATCHER_NOMATCH -1
+
+// Query syntax: "text" (substring), "~text" (fuzzy subsequence), "/regex" (regular expression)
+class SymbolMatcher
+{
+    public:
+        enum Mode { Substring = 0, Fuzzy, Regex };
+        struct Match { address_t address; int score; };
+
+    public:
+        explicit SymbolMatcher(const QString& query);
+        Mode mode() const;
+        const QString& pattern() const;
+        bool isRanked() const;
+        bool isValid() const;
+        int score(const QString& text) const;
+
+    public:
+        static int fuzzyScore(const QString& pattern, const QString& text);
+        static void mergeTop(QVector<Match>& top, QVector<Match> matches, int count);
+
+    private:
+        QRegularExpression m_regex;
+        QString m_pattern;
+        Mode m_mode;
+};
+
+#endif // SYMBOLMATCHER_H
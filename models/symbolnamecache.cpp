@@ -0,0 +1,132 @@
+#include "symbolnamecache.h"
+#include "../workchunks.h"
+#include "disassemblerregistry.h"
+#include "disassemblermodel.h"
+#include <redasm/support/demangler.h>
+#include <QtConcurrent>
+
+#define SYMBOLNAME_CACHE_COST   (4 * 1024 * 1024) // Characters
+#define SYMBOLNAME_CHUNK_SIZE   4096
+
+SymbolNameCache::SymbolNameCache(const REDasm::DisassemblerPtr &disassembler, QObject *parent): QObject(parent), m_disassembler(disassembler), m_names(SYMBOLNAME_CACHE_COST), m_stop(false), m_precomputing(false)
+{
+    EVENT_CONNECT(m_disassembler->document(), changed, this, [&](const REDasm::ListingDocumentChanged* ldc) {
+        if(ldc->isInserted()) // Renames and removals
+            return;
+
+        QMutexLocker locker(&m_mutex);
+        m_names.remove(ldc->item->address);
+
+        if(m_precomputing)
+            m_invalidated.insert(ldc->item->address);
+    });
+
+    EVENT_CONNECT(m_disassembler, busyChanged, this, [&]() {
+        if(!m_disassembler->busy())
+            QMetaObject::invokeMethod(this, "precompute", Qt::QueuedConnection);
+    });
+
+    if(!m_disassembler->busy()) // Loaded from a database
+        QMetaObject::invokeMethod(this, "precompute", Qt::QueuedConnection);
+}
+
+SymbolNameCache::~SymbolNameCache()
+{
+    EVENT_DISCONNECT(m_disassembler->document(), changed, this);
+    EVENT_DISCONNECT(m_disassembler, busyChanged, this);
+
+    m_stop = true;
+    m_watcher.waitForFinished();
+}
+
+QString SymbolNameCache::name(const REDasm::Symbol *symbol)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        QString* name = m_names.object(symbol->address);
+
+        if(name)
+            return *name;
+    }
+
+    QString name = this->displayName(symbol);
+    this->insert(symbol->address, name);
+    return name;
+}
+
+std::shared_ptr<SymbolNameCache> SymbolNameCache::get(const REDasm::DisassemblerPtr &disassembler) { return DisassemblerRegistry<SymbolNameCache>::get(disassembler); }
+
+void SymbolNameCache::precompute()
+{
+    if(m_watcher.isRunning())
+        return;
+
+    {
+        QMutexLocker locker(&m_mutex);
+        m_invalidated.clear();
+        m_precomputing = true;
+    }
+
+    m_watcher.setFuture(QtConcurrent::run([&]() {
+        QVector< QPair<address_t, std::string> > mangled;
+
+        {
+            auto lock = REDasm::s_lock_safe_ptr(m_disassembler->document());
+
+            for(size_t i = 0; !m_stop && (i < lock->size()); i++)
+            {
+                const REDasm::ListingItem* item = lock->itemAt(i);
+
+                if(!item->is(REDasm::ListingItem::FunctionItem) && !item->is(REDasm::ListingItem::SymbolItem))
+                    continue;
+
+                const REDasm::Symbol* symbol = lock->symbol(item->address);
+
+                if(symbol && !symbol->is(REDasm::SymbolType::StringMask)) // Strings are decoded on demand
+                    mangled.push_back(qMakePair(symbol->address, symbol->name));
+            }
+        }
+
+        auto chunks = workChunks<int>(0, mangled.size(), SYMBOLNAME_CHUNK_SIZE);
+
+        std::atomic<bool> full(false);
+
+        QtConcurrent::blockingMap(chunks, [&](const QPair<int, int>& chunk) {
+            for(int i = chunk.first; !m_stop && !full && (i < chunk.second); i++)
+            {
+                if(!this->insert(mangled[i].first, S_TO_QS(REDasm::Demangler::demangled(mangled[i].second)), true))
+                    full = true; // Going on would evict what has just been computed
+            }
+        });
+
+        m_precomputing = false;
+    }));
+}
+
+QString SymbolNameCache::displayName(const REDasm::Symbol *symbol) const
+{
+    if(symbol->is(REDasm::SymbolType::WideStringMask))
+        return S_TO_QS(REDasm::quoted(m_disassembler->readWString(symbol)));
+    else if(symbol->is(REDasm::SymbolType::StringMask))
+        return S_TO_QS(REDasm::quoted(m_disassembler->readString(symbol)));
+
+    return S_TO_QS(REDasm::Demangler::demangled(symbol->name));
+}
+
+bool SymbolNameCache::insert(address_t address, const QString &name, bool precomputed)
+{
+    QMutexLocker locker(&m_mutex);
+    int cost = std::max(1, name.size());
+
+    if(precomputed)
+    {
+        if(m_invalidated.contains(address) || m_names.contains(address)) // Don't overwrite newer names
+            return true;
+
+        if((m_names.totalCost() + cost) > m_names.maxCost()) // Warm up to the budget, never past it
+            return false;
+    }
+
+    m_names.insert(address, new QString(name), cost);
+    return true;
+}
@@ -0,0 +1,45 @@
+#ifndef SYMBOLNAMECACHE_H
+#define SYMBOLNAMECACHE_H
+
+#include <QObject>
+#include <QCache>
+#include <QSet>
+#include <QMutex>
+#include <QFutureWatcher>
+#include <atomic>
+#include <memory>
+#include <redasm/disassembler/disassemblerapi.h>
+#include <redasm/disassembler/listing/listingdocument.h>
+
+// Display names (demangled symbols, decoded strings) shared by every model of a disassembler:
+// bounded by total characters, dropped when the document changes the symbol.
+// Precomputing stops when the budget is full, names past it are resolved on demand.
+class SymbolNameCache : public QObject
+{
+    Q_OBJECT
+
+    public:
+        explicit SymbolNameCache(const REDasm::DisassemblerPtr& disassembler, QObject *parent = nullptr);
+        ~SymbolNameCache();
+        QString name(const REDasm::Symbol* symbol);
+
+    public:
+        static std::shared_ptr<SymbolNameCache> get(const REDasm::DisassemblerPtr& disassembler);
+
+    private slots:
+        void precompute();
+
+    private:
+        QString displayName(const REDasm::Symbol* symbol) const;
+        bool insert(address_t address, const QString& name, bool precomputed = false);
+
+    private:
+        REDasm::DisassemblerPtr m_disassembler;
+        QCache<address_t, QString> m_names;
+        QSet<address_t> m_invalidated; // Changed while precomputing
+        QFutureWatcher<void> m_watcher;
+        QMutex m_mutex;
+        std::atomic<bool> m_stop, m_precomputing;
+};
+
+#endif // SYMBOLNAMECACHE_H
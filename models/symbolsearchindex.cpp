@@ -0,0 +1,330 @@
+#include "symbolsearchindex.h"
+#include "../workchunks.h"
+#include "disassemblerregistry.h"
+#include "disassemblermodel.h"
+#include "segmentsmodel.h"
+#include <QtConcurrent>
+#include <QTimer>
+#include <algorithm>
+
+#define SEARCH_TRIGRAM        3
+#define SEARCH_CHUNK_SIZE     4096
+#define SEARCH_UPDATE_DELAY   100 // ms
+
+SymbolSearchIndex::SymbolSearchIndex(const REDasm::DisassemblerPtr &disassembler, QObject *parent): QObject(parent), m_disassembler(disassembler), m_ready(false), m_stop(false)
+{
+    m_names = SymbolNameCache::get(disassembler);
+    connect(&m_watcher, &QFutureWatcher<void>::finished, this, &SymbolSearchIndex::applyUpdates); // Renamed while building
+
+    EVENT_CONNECT(m_disassembler->document(), changed, this, [&](const REDasm::ListingDocumentChanged* ldc) {
+        if(m_disassembler->busy()) // The build that follows the analysis sees these
+            return;
+
+        QMutexLocker locker(&m_dirtymutex);
+
+        if(m_dirty.empty())
+            QMetaObject::invokeMethod(this, "scheduleUpdate", Qt::QueuedConnection);
+
+        m_dirty.push_back(ldc->item->address);
+    });
+
+    EVENT_CONNECT(m_disassembler, busyChanged, this, [&]() {
+        if(!m_disassembler->busy())
+            QMetaObject::invokeMethod(this, "startBuild", Qt::QueuedConnection);
+    });
+
+    if(!m_disassembler->busy()) // Loaded from a database
+        QMetaObject::invokeMethod(this, "startBuild", Qt::QueuedConnection);
+}
+
+SymbolSearchIndex::~SymbolSearchIndex()
+{
+    EVENT_DISCONNECT(m_disassembler->document(), changed, this);
+    EVENT_DISCONNECT(m_disassembler, busyChanged, this);
+
+    m_stop = true;
+    m_watcher.waitForFinished();
+}
+
+bool SymbolSearchIndex::query(const QString &s, QVector<address_t> *addresses) const
+{
+    if(!m_ready || (s.size() < SEARCH_TRIGRAM))
+        return false;
+
+    QString needle = s.toLower();
+    QVector<quint32> keys = SymbolSearchIndex::trigrams(needle);
+    QReadLocker locker(&m_rwlock);
+    QVector< QVector<int> > lists;
+
+    for(quint32 key : keys)
+        lists.push_back(this->postings(key));
+
+    std::sort(lists.begin(), lists.end(), [](const QVector<int>& a, const QVector<int>& b) { return a.size() < b.size(); });
+    QVector<int> candidates = lists.front(); // Start from the rarest trigram
+
+    for(int i = 1; (i < lists.size()) && !candidates.empty(); i++)
+    {
+        QVector<int> intersection;
+        std::set_intersection(candidates.begin(), candidates.end(), lists[i].begin(), lists[i].end(), std::back_inserter(intersection));
+        candidates.swap(intersection);
+    }
+
+    addresses->clear();
+
+    for(int id : candidates)
+    {
+        const Entry& entry = m_entries[id];
+
+        if(entry.alive && entry.text.contains(needle)) // Trigram hits may be false positives
+            addresses->push_back(entry.address);
+    }
+
+    std::sort(addresses->begin(), addresses->end());
+    return true;
+}
+
+std::shared_ptr<SymbolSearchIndex> SymbolSearchIndex::get(const REDasm::DisassemblerPtr &disassembler) { return DisassemblerRegistry<SymbolSearchIndex>::get(disassembler); }
+
+void SymbolSearchIndex::startBuild()
+{
+    if(!m_watcher.isRunning())
+        m_watcher.setFuture(QtConcurrent::run([&]() { this->build(); }));
+}
+
+void SymbolSearchIndex::scheduleUpdate() { QTimer::singleShot(SEARCH_UPDATE_DELAY, this, &SymbolSearchIndex::applyUpdates); }
+
+void SymbolSearchIndex::applyUpdates()
+{
+    if(!m_ready || m_watcher.isRunning()) // Applied when the build finishes
+        return;
+
+    QVector<address_t> dirty;
+
+    {
+        QMutexLocker locker(&m_dirtymutex);
+        dirty.swap(m_dirty);
+    }
+
+    if(dirty.empty())
+        return;
+
+    std::sort(dirty.begin(), dirty.end());
+    dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+
+    QVector< QPair<address_t, QString> > texts;
+    int bits = m_disassembler->assembler()->bits();
+
+    {
+        auto lock = REDasm::s_lock_safe_ptr(m_disassembler->document());
+
+        for(address_t address : dirty)
+        {
+            QStringList names;
+            const REDasm::Segment* segment = lock->segment(address);
+            const REDasm::Symbol* symbol = lock->symbol(address);
+
+            if(segment && (segment->address == address))
+                names.push_back(SegmentsModel::segmentText(segment, bits));
+
+            if(symbol)
+            {
+                names.push_back(m_names->name(symbol));
+                names.push_back(segment ? S_TO_QS(segment->name) : QString("???")); // Containing segment column
+            }
+
+            texts.push_back(qMakePair(address, names.empty() ? QString() : this->entryText(address, names)));
+        }
+    }
+
+    QWriteLocker locker(&m_rwlock);
+
+    for(const auto& text : texts)
+    {
+        auto it = m_entryindex.find(text.first);
+
+        if(it != m_entryindex.end())
+        {
+            m_entries[it.value()].alive = false;
+            m_entryindex.erase(it);
+        }
+
+        if(!text.second.isEmpty())
+            this->addEntry(text.first, text.second);
+    }
+
+    if((m_entries.size() - m_entryindex.size()) > m_entryindex.size()) // Mostly dead entries, start over
+        QMetaObject::invokeMethod(this, "startBuild", Qt::QueuedConnection);
+}
+
+void SymbolSearchIndex::build()
+{
+    struct Name { address_t address; QString text; bool symbol; }; // Symbols are resolved later
+
+    QVector<Name> names;
+    int bits = m_disassembler->assembler()->bits();
+
+    {
+        auto lock = REDasm::s_lock_safe_ptr(m_disassembler->document());
+        auto chunks = workChunks<size_t>(0, lock->size(), SEARCH_CHUNK_SIZE);
+
+        // Writers are blocked by 'lock' while the workers read the document
+        auto results = QtConcurrent::blockingMapped< QVector< QVector<Name> > >(chunks, [&](const QPair<size_t, size_t>& chunk) -> QVector<Name> {
+            QVector<Name> chunknames;
+
+            for(size_t i = chunk.first; !m_stop && (i < chunk.second); i++)
+            {
+                const REDasm::ListingItem* item = lock->itemAt(i);
+
+                if(item->is(REDasm::ListingItem::SegmentItem))
+                {
+                    const REDasm::Segment* segment = lock->segment(item->address);
+
+                    if(segment)
+                        chunknames.push_back({ item->address, SegmentsModel::segmentText(segment, bits), false });
+                }
+                else if(item->is(REDasm::ListingItem::FunctionItem) || item->is(REDasm::ListingItem::SymbolItem))
+                {
+                    const REDasm::Segment* segment = lock->segment(item->address);
+                    chunknames.push_back({ item->address, QString(), true });
+                    chunknames.push_back({ item->address, segment ? S_TO_QS(segment->name) : QString("???"), false }); // Containing segment column
+                }
+                else if(item->is(REDasm::ListingItem::TypeItem))
+                    chunknames.push_back({ item->address, S_TO_QS(lock->type(item)), false });
+            }
+
+            return chunknames;
+        });
+
+        for(const auto& result : results)
+            names += result;
+    }
+
+    if(m_stop)
+        return;
+
+    // Display names may read the document (strings), which locks it: workers must not run under a lock held here
+    QtConcurrent::blockingMap(names, [&](Name& name) {
+        if(m_stop || !name.symbol)
+            return;
+
+        const REDasm::Symbol* symbol = m_disassembler->document()->symbol(name.address);
+
+        if(symbol)
+            name.text = m_names->name(symbol);
+    });
+
+    if(m_stop)
+        return;
+
+    QVector<Entry> entries;
+    QHash<address_t, int> entryindex;
+
+    for(int i = 0; i < names.size(); )
+    {
+        QStringList addressnames;
+        int j = i;
+
+        for( ; (j < names.size()) && (names[j].address == names[i].address); j++) // Items of the same address are adjacent
+        {
+            if(!names[j].text.isEmpty()) // Symbol removed meanwhile
+                addressnames.push_back(names[j].text);
+        }
+
+        if(!addressnames.empty())
+        {
+            entryindex[names[i].address] = entries.size();
+            entries.push_back({ names[i].address, this->entryText(names[i].address, addressnames), true });
+        }
+
+        i = j;
+    }
+
+    auto chunks = workChunks<int>(0, entries.size(), SEARCH_CHUNK_SIZE);
+
+    auto pairs = QtConcurrent::blockingMappedReduced< QVector<quint64> >(chunks, [&](const QPair<int, int>& chunk) -> QVector<quint64> {
+        QVector<quint64> chunkpairs;
+
+        for(int i = chunk.first; i < chunk.second; i++)
+        {
+            for(quint32 key : SymbolSearchIndex::trigrams(entries[i].text))
+                chunkpairs.push_back((static_cast<quint64>(key) << 32) | static_cast<quint32>(i));
+        }
+
+        return chunkpairs;
+    }, [](QVector<quint64>& result, const QVector<quint64>& chunkpairs) { result += chunkpairs; });
+
+    std::sort(pairs.begin(), pairs.end()); // Grouped by key, ids ascending
+
+    QVector<quint32> keys;
+    QVector<int> offsets, ids;
+    ids.reserve(pairs.size());
+
+    for(quint64 pair : pairs)
+    {
+        quint32 key = static_cast<quint32>(pair >> 32);
+
+        if(keys.empty() || (keys.back() != key))
+        {
+            keys.push_back(key);
+            offsets.push_back(ids.size());
+        }
+
+        ids.push_back(static_cast<int>(pair & 0xFFFFFFFF));
+    }
+
+    offsets.push_back(ids.size());
+
+    QWriteLocker locker(&m_rwlock);
+    m_entries.swap(entries);
+    m_entryindex.swap(entryindex);
+    m_keys.swap(keys);
+    m_offsets.swap(offsets);
+    m_ids.swap(ids);
+    m_delta.clear();
+    m_ready = true;
+}
+
+void SymbolSearchIndex::addEntry(address_t address, const QString &text)
+{
+    int id = m_entries.size();
+    m_entries.push_back({ address, text, true });
+    m_entryindex[address] = id;
+
+    for(quint32 key : SymbolSearchIndex::trigrams(text))
+        m_delta[key].push_back(id);
+}
+
+QString SymbolSearchIndex::entryText(address_t address, const QStringList &names) const
+{
+    // Same address format of the models, so both columns can be searched
+    return (S_TO_QS(REDasm::hex(address, m_disassembler->assembler()->bits())) + "\n" + names.join("\n")).toLower();
+}
+
+QVector<int> SymbolSearchIndex::postings(quint32 key) const
+{
+    QVector<int> ids;
+    auto it = std::lower_bound(m_keys.begin(), m_keys.end(), key);
+
+    if((it != m_keys.end()) && (*it == key))
+    {
+        int idx = static_cast<int>(it - m_keys.begin());
+        ids = m_ids.mid(m_offsets[idx], m_offsets[idx + 1] - m_offsets[idx]);
+    }
+
+    return ids + m_delta.value(key); // Updated entries always have greater ids
+}
+
+QVector<quint32> SymbolSearchIndex::trigrams(const QString &s)
+{
+    QVector<quint32> keys;
+
+    for(int i = 0; (i + SEARCH_TRIGRAM) <= s.size(); i++)
+    {
+        // Collisions are harmless: every candidate is verified
+        keys.push_back((s[i].unicode() * 0x9E3779B1u) ^ (s[i + 1].unicode() * 0x85EBCA77u) ^ (s[i + 2].unicode() * 0xC2B2AE3Du));
+    }
+
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    return keys;
+}
@@ -0,0 +1,63 @@
+#ifndef SYMBOLSEARCHINDEX_H
+#define SYMBOLSEARCHINDEX_H
+
+#include <QObject>
+#include <QVector>
+#include <QHash>
+#include <QMutex>
+#include <QReadWriteLock>
+#include <QFutureWatcher>
+#include <atomic>
+#include <memory>
+#include <redasm/disassembler/disassemblerapi.h>
+#include <redasm/disassembler/listing/listingdocument.h>
+#include "symbolnamecache.h"
+
+// Trigram inverted index over the searchable columns of the listing models (symbols, strings, segments and types).
+// Substring queries intersect the posting lists of the query's trigrams and verify the few survivors.
+// An address' entry joins the columns of every model showing it, so hits are a superset of a single model's
+// matches and callers verify them against their own columns. Reference counts are left out: they change
+// without an event on their address.
+class SymbolSearchIndex : public QObject
+{
+    Q_OBJECT
+
+    private:
+        struct Entry { address_t address; QString text; bool alive; }; // 'text' is lowercase
+
+    public:
+        explicit SymbolSearchIndex(const REDasm::DisassemblerPtr& disassembler, QObject *parent = nullptr);
+        ~SymbolSearchIndex();
+        bool query(const QString& s, QVector<address_t>* addresses) const;
+
+    public:
+        static std::shared_ptr<SymbolSearchIndex> get(const REDasm::DisassemblerPtr& disassembler);
+
+    private slots:
+        void startBuild();
+        void scheduleUpdate();
+        void applyUpdates();
+
+    private:
+        void build();
+        void addEntry(address_t address, const QString& text);
+        QString entryText(address_t address, const QStringList& names) const;
+        QVector<int> postings(quint32 key) const;
+        static QVector<quint32> trigrams(const QString& s);
+
+    private:
+        REDasm::DisassemblerPtr m_disassembler;
+        std::shared_ptr<SymbolNameCache> m_names;
+        QVector<Entry> m_entries;
+        QHash<address_t, int> m_entryindex;      // Live entry of an address
+        QVector<quint32> m_keys;                 // Sorted trigram keys...
+        QVector<int> m_offsets, m_ids;           // ...and their posting lists, built once
+        QHash<quint32, QVector<int> > m_delta;   // Postings of entries updated after the build
+        QVector<address_t> m_dirty;
+        QFutureWatcher<void> m_watcher;
+        mutable QReadWriteLock m_rwlock;
+        QMutex m_dirtymutex;
+        std::atomic<bool> m_ready, m_stop;
+};
+
+#endif // SYMBOLSEARCHINDEX_H
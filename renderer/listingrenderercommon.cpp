@@ -82,6 +82,25 @@ REDasm::ListingRenderer::Range ListingRendererCommon::wordHitTest(const QPointF
 }
 
 void ListingRendererCommon::setFirstVisibleLine(size_t line) { m_firstline = line; }
+
+QSizeF ListingRendererCommon::measureLines(size_t first, size_t count)
+{
+    // Font is monospaced: text width is just 'longest line' * 'character width'
+    size_t maxlength = 0;
+
+    for(size_t i = 0; i < count; i++)
+    {
+        REDasm::RendererLine rl(true);
+
+        if(!this->getRendererLine(first + i, rl))
+            continue;
+
+        maxlength = std::max(maxlength, rl.text.size());
+    }
+
+    return { maxlength * m_fontmetrics.width(' '), count * m_fontmetrics.height() };
+}
+
 const QFontMetricsF ListingRendererCommon::fontMetrics() const { return m_fontmetrics; }
 qreal ListingRendererCommon::maxWidth() const { return m_maxwidth; }
 
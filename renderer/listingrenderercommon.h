@@ -22,6 +22,7 @@ class ListingRendererCommon: public REDasm::ListingRenderer
         std::string getWordFromPos(const QPointF& pos, Range *wordpos = nullptr);
         void selectWordAt(const QPointF &pos);
         void setFirstVisibleLine(size_t line);
+        QSizeF measureLines(size_t first, size_t count);
         const QFontMetricsF fontMetrics() const;
         qreal maxWidth() const;
 
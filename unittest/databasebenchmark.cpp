@@ -0,0 +1,133 @@
+#include "databasebenchmark.h"
+#include "testmacros.h"
+#include "../databaseloader.h"
+#include "../chunkedfile.h"
+#include <redasm/database/database.h>
+#include <redasm/disassembler/disassembler.h>
+#include <QStandardPaths>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <QFileInfo>
+#include <QDir>
+#include <iostream>
+#include <memory>
+
+#define BENCHMARK_RANGE_SIZE 65536
+#define BENCHMARK_BLOCK_SIZE (1024 * 1024)
+
+using namespace std;
+using namespace REDasm;
+
+static bool sameContents(const QString& filepath1, const QString& filepath2)
+{
+    QFile file1(filepath1), file2(filepath2);
+
+    if(!file1.open(QFile::ReadOnly) || !file2.open(QFile::ReadOnly) || (file1.size() != file2.size()))
+        return false;
+
+    while(!file1.atEnd())
+    {
+        if(file1.read(BENCHMARK_BLOCK_SIZE) != file2.read(BENCHMARK_BLOCK_SIZE))
+            return false;
+    }
+
+    return true;
+}
+
+DatabaseBenchmark::DatabaseBenchmark()
+{
+    ContextSettings ctxsettings;
+    ctxsettings.tempPath = QStandardPaths::writableLocation(QStandardPaths::TempLocation).toStdString();
+    ctxsettings.searchPath = QDir::currentPath().toStdString();
+    ctxsettings.logCallback = [](const std::string&) { };
+    ctxsettings.ignoreproblems = true;
+    REDasm::init(ctxsettings);
+}
+
+void DatabaseBenchmark::run(const QStringList &rdbpaths)
+{
+    for(const QString& rdbpath : rdbpaths)
+    {
+        QFileInfo fi(rdbpath);
+
+        if(!fi.exists())
+        {
+            cout << "!!! SKIPPING '" << qUtf8Printable(fi.fileName()) << "', file not found..." << endl << endl;
+            continue;
+        }
+
+        TITLE("Benchmarking " << qUtf8Printable(fi.fileName()));
+        this->runCurrentBenchmark(rdbpath);
+        cout << REPEATED('-') << REPEATED('-') << REPEATED('-') << endl << endl;
+    }
+}
+
+void DatabaseBenchmark::runCurrentBenchmark(const QString &rdbpath)
+{
+    QTemporaryDir tempdir;
+    QString plainpath = tempdir.filePath("plain.rdb"), rawpath = tempdir.filePath("raw.rdb");
+    QString chunkedpath = tempdir.filePath("chunked.rdbz"), extractedpath = tempdir.filePath("extracted.rdb");
+    std::string filename;
+    QElapsedTimer timer;
+
+    std::unique_ptr<Disassembler> disassembler(Database::load(rdbpath.toStdString(), filename));
+    TEST("Loading", disassembler);
+
+    if(!disassembler)
+        return;
+
+    // Both formats are written from the same state, the compressed one pays for serialization too
+    timer.start();
+    bool ok = Database::save(disassembler.get(), plainpath.toStdString(), filename);
+    qint64 plainsave = timer.elapsed();
+
+    ChunkedFile chunkedfile;
+    timer.restart();
+    ok = ok && Database::save(disassembler.get(), rawpath.toStdString(), filename) && chunkedfile.compress(rawpath, chunkedpath);
+    qint64 chunkedsave = timer.elapsed();
+    TEST("Saving", ok);
+
+    if(!ok)
+        return;
+
+    disassembler.reset();
+
+    // Both loads read from 'tempdir', the compressed one is inflated next to the plain one
+    timer.restart();
+    disassembler.reset(Database::load(plainpath.toStdString(), filename));
+    qint64 plainload = timer.elapsed();
+    ok = static_cast<bool>(disassembler);
+    disassembler.reset();
+
+    DatabaseLoader loader(tempdir.path());
+    timer.restart();
+    disassembler.reset(loader.load(chunkedpath));
+    qint64 chunkedload = timer.elapsed();
+
+    ok = ok && disassembler && chunkedfile.open(chunkedpath) && chunkedfile.extract(extractedpath);
+    TEST("Round trip", ok && sameContents(rawpath, extractedpath));
+
+    timer.restart();
+    QByteArray range = chunkedfile.read(chunkedfile.size() / 2, BENCHMARK_RANGE_SIZE);
+    qint64 rangeread = timer.nsecsElapsed() / 1000;
+
+    qint64 plainsize = QFileInfo(plainpath).size(), chunkedsize = QFileInfo(chunkedpath).size();
+
+    cout << "->> Size: " << qUtf8Printable(DatabaseBenchmark::formatSize(plainsize)) << " plain, "
+         << qUtf8Printable(DatabaseBenchmark::formatSize(chunkedsize)) << " compressed ("
+         << ((chunkedsize * 100) / std::max<qint64>(plainsize, 1)) << "%), " << chunkedfile.count() << " chunk(s)" << endl;
+
+    cout << "->> Save: " << plainsave << " ms plain, " << chunkedsave << " ms compressed" << endl;
+    cout << "->> Load: " << plainload << " ms plain, " << chunkedload << " ms compressed" << endl;
+    cout << "->> Range read (" << range.size() << " bytes): " << rangeread << " us" << endl;
+}
+
+QString DatabaseBenchmark::formatSize(qint64 size)
+{
+    if(size >= (1024 * 1024))
+        return QString::number(size / (1024.0 * 1024.0), 'f', 2) + " MiB";
+    if(size >= 1024)
+        return QString::number(size / 1024.0, 'f', 2) + " KiB";
+
+    return QString::number(size) + " bytes";
+}
@@ -0,0 +1,20 @@
+#ifndef DATABASEBENCHMARK_H
+#define DATABASEBENCHMARK_H
+
+#include <QStringList>
+#include <QString>
+
+// Compares the plain and the chunked compressed database formats on existing projects:
+//   REDasm --benchmark-db <database.rdb> [<database.rdb> ...]
+class DatabaseBenchmark
+{
+    public:
+        DatabaseBenchmark();
+        void run(const QStringList& rdbpaths);
+
+    private:
+        void runCurrentBenchmark(const QString& rdbpath);
+        static QString formatSize(qint64 size);
+};
+
+#endif // DATABASEBENCHMARK_H
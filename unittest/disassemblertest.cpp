@@ -1,4 +1,5 @@
 #include "disassemblertest.h"
+#include "testmacros.h"
 #include <redasm/disassembler/disassembler.h>
 #include <QStandardPaths>
 #include <QApplication>
@@ -11,18 +12,6 @@
 #define TEST_PREFIX                      "/home/davide/Programmazione/Campioni/" // NOTE: Yes, hardcoded for now :(
 #define TEST_PATH(s)                     TEST_PREFIX + std::string(s)
 
-#define REPEAT_COUNT                     20
-#define REPEATED(s)                      std::string(REPEAT_COUNT, s)
-
-#define RED_STRING(s)                    ("\x1b[31m" + std::string(s) + "\x1b[0m")
-#define GREEN_STRING(s)                  ("\x1b[32m" + std::string(s) + "\x1b[0m")
-#define TEST_OK                          GREEN_STRING("OK")
-#define TEST_FAIL                        RED_STRING("FAIL")
-
-#define TEST(s, cond)                    cout << "->> " << s << "..." << ((cond) ? TEST_OK : TEST_FAIL) << endl
-#define TITLE(t)                         cout << REPEATED('-') << t << " " << REPEATED('-') << endl
-#define TEST_TITLE(t)                    TITLE("Testing " << t)
-
 #define TEST_NAME(sym, s)                (sym->name == s)
 #define TEST_SYMBOL(s, sym, exp)         TEST(s, (sym && exp))
 #define TEST_SYMBOL_NAME(s, sym, exp, n) TEST_SYMBOL(s, sym, TEST_NAME(sym, n) && exp)
@@ -0,0 +1,19 @@
+#ifndef TESTMACROS_H
+#define TESTMACROS_H
+
+#include <iostream>
+#include <string>
+
+#define REPEAT_COUNT                     20
+#define REPEATED(s)                      std::string(REPEAT_COUNT, s)
+
+#define RED_STRING(s)                    ("\x1b[31m" + std::string(s) + "\x1b[0m")
+#define GREEN_STRING(s)                  ("\x1b[32m" + std::string(s) + "\x1b[0m")
+#define TEST_OK                          GREEN_STRING("OK")
+#define TEST_FAIL                        RED_STRING("FAIL")
+
+#define TEST(s, cond)                    std::cout << "->> " << s << "..." << ((cond) ? TEST_OK : TEST_FAIL) << std::endl
+#define TITLE(t)                         std::cout << REPEATED('-') << t << " " << REPEATED('-') << std::endl
+#define TEST_TITLE(t)                    TITLE("Testing " << t)
+
+#endif // TESTMACROS_H
@@ -1,5 +1,6 @@
 #include "unittest.h"
 #include "disassemblertest.h"
+#include "databasebenchmark.h"
 #include <redasm/redasm_context.h>
 
 int UnitTest::run()
@@ -9,3 +10,11 @@ int UnitTest::run()
     disasmtest.runTests();
     return 0;
 }
+
+int UnitTest::benchmarkDatabases(const QStringList &rdbpaths)
+{
+    REDasm::Context::sync(true);
+    DatabaseBenchmark dbbenchmark;
+    dbbenchmark.run(rdbpaths);
+    return 0;
+}
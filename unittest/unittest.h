@@ -1,10 +1,13 @@
 #ifndef UNITTEST_H
 #define UNITTEST_H
 
+#include <QStringList>
+
 class UnitTest
 {
     public:
         static int run();
+        static int benchmarkDatabases(const QStringList& rdbpaths);
 };
 
 #endif // UNITTEST
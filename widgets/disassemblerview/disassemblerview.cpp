@@ -2,12 +2,15 @@
 #include "ui_disassemblerview.h"
 #include "../../dialogs/dev/iteminformationdialog/iteminformationdialog.h"
 #include "../../dialogs/referencesdialog/referencesdialog.h"
+#include "../../dialogs/createsignaturedialog/createsignaturedialog.h"
 #include "../../themeprovider.h"
 #include "../../redasmsettings.h"
-#include <QHexView/document/buffer/qmemoryrefbuffer.h>
+#include "mappedhexbuffer.h"
+#include <QInputDialog>
 #include <QMessageBox>
 #include <QPushButton>
 #include <QDebug>
+#include <limits>
 
 DisassemblerView::DisassemblerView(QLineEdit *lefilter, QWidget *parent) : QWidget(parent), ui(new Ui::DisassemblerView), m_disassembler(nullptr), m_hexdocument(nullptr), m_lefilter(lefilter)
 {
@@ -18,6 +21,7 @@ DisassemblerView::DisassemblerView(QLineEdit *lefilter, QWidget *parent) : QWidg
 
     m_listingview = new DisassemblerListingView(this);
     m_graphview = new DisassemblerGraphView(this);
+    m_programgraphview = new ProgramGraphView(this);
 
     ui->hexView->setFont(REDasmSettings::font());
     ui->hexView->setFrameShape(QFrame::NoFrame);
@@ -25,6 +29,7 @@ DisassemblerView::DisassemblerView(QLineEdit *lefilter, QWidget *parent) : QWidg
 
     ui->stackedWidget->addWidget(m_listingview);
     ui->stackedWidget->addWidget(m_graphview);
+    ui->tabView->addTab(m_programgraphview, "Call Graph");
 
     m_importsmodel = ListingFilterModel::createFilter<SymbolTableModel>(REDasm::ListingItem::SymbolItem, ui->tvImports);
     static_cast<SymbolTableModel*>(m_importsmodel->sourceModel())->setSymbolType(REDasm::SymbolType::ImportMask);
@@ -71,14 +76,17 @@ DisassemblerView::DisassemblerView(QLineEdit *lefilter, QWidget *parent) : QWidg
         m_actions->setVisible(DisassemblerViewActions::BackAction, (ui->tabView->currentWidget() == ui->tabListing));
         m_actions->setVisible(DisassemblerViewActions::ForwardAction, (ui->tabView->currentWidget() == ui->tabListing));
         m_actions->setVisible(DisassemblerViewActions::GraphListingAction, (ui->tabView->currentWidget() == ui->tabListing));
+
+        if((ui->tabView->currentWidget() == m_programgraphview) && !m_programgraphview->isBuilt())
+            m_programgraphview->build();
     });
 
     connect(m_lefilter, &QLineEdit::textChanged, this, [&](const QString&) { this->filterSymbols(); });
 
     connect(m_listingview->textView(), &DisassemblerTextView::addressChanged, this, &DisassemblerView::displayAddress);
-    connect(m_listingview->textView(), &DisassemblerTextView::addressChanged, this, &DisassemblerView::displayCurrentReferences);
+    connect(m_listingview->textView(), &DisassemblerTextView::addressChanged, m_docks, &DisassemblerViewDocks::scheduleUpdate);
     connect(m_listingview->textView(), &DisassemblerTextView::switchView, this, &DisassemblerView::switchGraphListing);
-    connect(m_listingview->textView(), &DisassemblerTextView::addressChanged, m_docks, &DisassemblerViewDocks::updateCallGraph);
+    connect(m_docks, &DisassemblerViewDocks::referencesRequested, this, &DisassemblerView::displayCurrentReferences);
 
     connect(m_graphview, &DisassemblerGraphView::switchView, this, &DisassemblerView::switchGraphListing);
     connect(m_graphview, &DisassemblerGraphView::gotoDialogRequested, this, &DisassemblerView::showGoto);
@@ -88,6 +96,11 @@ DisassemblerView::DisassemblerView(QLineEdit *lefilter, QWidget *parent) : QWidg
     connect(m_graphview, &DisassemblerGraphView::itemInformationRequested, this, &DisassemblerView::showCurrentItemInfo);
     connect(m_graphview, &DisassemblerGraphView::callGraphRequested, m_docks, &DisassemblerViewDocks::initializeCallGraph);
 
+    connect(m_programgraphview, &ProgramGraphView::functionActivated, this, [&](address_t address) {
+        ui->tabView->setCurrentWidget(ui->tabListing);
+        m_disassembler->document()->goTo(address);
+    });
+
     connect(m_actions, &DisassemblerViewActions::backRequested, this, &DisassemblerView::goBack);
     connect(m_actions, &DisassemblerViewActions::forwardRequested, this, &DisassemblerView::goForward);
     connect(m_actions, &DisassemblerViewActions::gotoRequested, this, &DisassemblerView::showGoto);
@@ -130,11 +143,17 @@ void DisassemblerView::bindDisassembler(REDasm::DisassemblerAPI *disassembler, b
     m_segmentsmodel->setDisassembler(m_disassembler);
 
     REDasm::AbstractBuffer* buffer = m_disassembler->loader()->buffer();
-    m_hexdocument = QHexDocument::fromMemory<QMemoryRefBuffer>(reinterpret_cast<char*>(buffer->data()), buffer->size(), ui->hexView);
+    int hexsize = static_cast<int>(std::min<u64>(buffer->size(), std::numeric_limits<int>::max())); // QHexView addresses with int
+
+    if(static_cast<u64>(hexsize) < buffer->size())
+        REDasm::log("Hex view limited to the first " + std::to_string(hexsize) + " bytes");
+
+    m_hexdocument = QHexDocument::fromMemory<MappedHexBuffer>(reinterpret_cast<char*>(buffer->data()), hexsize, ui->hexView);
     ui->hexView->setDocument(m_hexdocument);
 
     m_listingview->setDisassembler(m_disassembler);
     m_graphview->setDisassembler(m_disassembler);
+    m_programgraphview->setDisassembler(m_disassembler);
 
     ui->stackedWidget->currentWidget()->setFocus();
 
@@ -185,12 +204,18 @@ void DisassemblerView::checkDisassemblerStatus()
 
     m_actions->setEnabled(DisassemblerViewActions::GotoAction, !m_disassembler->busy());
     m_actions->setEnabled(DisassemblerViewActions::GraphListingAction, !m_disassembler->busy());
+
+    if(!m_disassembler->busy() && (ui->tabView->currentWidget() == m_programgraphview) && !m_programgraphview->isBuilt())
+        m_programgraphview->build();
 }
 
 void DisassemblerView::modelIndexSelected(const QModelIndex &index)
 {
     m_currentindex = index;
     m_actsetfilter->setVisible(index.isValid() && (index.model() != m_docks->callTreeModel()));
+    m_actexpandall->setVisible(index.isValid() && (index.model() == m_docks->callTreeModel()));
+    m_actexpanddepth->setVisible(m_actexpandall->isVisible());
+    m_actcreatesignature->setVisible(index.isValid() && (index.model() == m_docks->functionsModel()));
 }
 
 void DisassemblerView::checkHexEdit(int index)
@@ -478,6 +503,25 @@ void DisassemblerView::showGoto()
     this->selectToHexDump(dlggoto.address(), m_disassembler->assembler()->addressWidth());
 }
 
+void DisassemblerView::showCreateSignature()
+{
+    if(m_disassembler->busy())
+        return;
+
+    QVector<address_t> functions;
+
+    for(const QModelIndex& index : m_docks->functionsView()->selectionModel()->selectedRows())
+    {
+        const REDasm::ListingItem* item = m_docks->functionsModel()->item(index);
+
+        if(item)
+            functions.push_back(item->address);
+    }
+
+    CreateSignatureDialog dlgcreatesignature(m_disassembler.get(), functions, this);
+    dlgcreatesignature.exec();
+}
+
 void DisassemblerView::goForward() { m_disassembler->document()->cursor()->goForward(); }
 void DisassemblerView::goBack() { m_disassembler->document()->cursor()->goBack(); }
 
@@ -491,7 +535,12 @@ const REDasm::ListingItem *DisassemblerView::itemFromIndex(const QModelIndex &in
     const GotoModel* gotomodel = dynamic_cast<const GotoModel*>(index.model());
 
     if(gotomodel)
-        return reinterpret_cast<REDasm::ListingItem*>(index.internalPointer());
+        return gotomodel->item(index);
+
+    const CallTreeModel* calltreemodel = dynamic_cast<const CallTreeModel*>(index.model());
+
+    if(calltreemodel)
+        return calltreemodel->item(index);
 
     return nullptr;
 }
@@ -545,6 +594,22 @@ void DisassemblerView::createActions()
     m_actsetfilter = m_contextmenu->addAction("Set Filter", this, &DisassemblerView::showFilter);
     this->addAction(m_actsetfilter);
 
+    m_actexpandall = m_contextmenu->addAction("Expand All", [&]() { m_docks->callTreeModel()->expand(m_currentindex); });
+
+    m_actexpanddepth = m_contextmenu->addAction("Expand to Depth...", [&]() {
+        bool ok = false;
+        int depth = QInputDialog::getInt(this, "Expand Call Tree", "Depth:", 3, 1, 64, 1, &ok);
+
+        if(ok)
+            m_docks->callTreeModel()->expand(m_currentindex, depth);
+    });
+
+    m_actcreatesignature = m_contextmenu->addAction("Create Signature...", this, &DisassemblerView::showCreateSignature);
+
+    m_actexpandall->setVisible(false);
+    m_actexpanddepth->setVisible(false);
+    m_actcreatesignature->setVisible(false);
+
     m_contextmenu->addSeparator();
     m_contextmenu->addAction("Cross References", this, &DisassemblerView::showModelReferences);
     m_contextmenu->addAction("Goto", [&]() { this->goTo(m_currentindex); });
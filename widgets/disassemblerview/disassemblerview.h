@@ -10,6 +10,7 @@
 #include "../../models/segmentsmodel.h"
 #include "../../dialogs/gotodialog/gotodialog.h"
 #include "../graphview/disassemblergraphview/disassemblergraphview.h"
+#include "../graphview/programgraphview/programgraphview.h"
 #include "../disassemblerlistingview/disassemblerlistingview.h"
 #include "disassemblerviewactions.h"
 #include "disassemblerviewdocks.h"
@@ -51,6 +52,7 @@ class DisassemblerView : public QWidget
         void selectToHexDump(address_t address, u64 len);
         void showMenu(const QPoint&);
         void showGoto();
+        void showCreateSignature();
         void goForward();
         void goBack();
 
@@ -69,13 +71,14 @@ class DisassemblerView : public QWidget
         DisassemblerViewActions* m_actions;
         DisassemblerViewDocks* m_docks;
         DisassemblerGraphView* m_graphview;
+        ProgramGraphView* m_programgraphview;
         DisassemblerListingView* m_listingview;
         QModelIndex m_currentindex;
         QHexDocument* m_hexdocument;
         QMenu* m_contextmenu;
         QLineEdit* m_lefilter;
         ListingFilterModel *m_segmentsmodel, *m_importsmodel, *m_exportsmodel, *m_stringsmodel;
-        QAction* m_actsetfilter;
+        QAction *m_actsetfilter, *m_actexpandall, *m_actexpanddepth, *m_actcreatesignature;
 };
 
 #endif // DISASSEMBLERVIEW_H
@@ -2,8 +2,15 @@
 #include <QHeaderView>
 #include <QApplication>
 
-DisassemblerViewDocks::DisassemblerViewDocks(QObject *parent) : QObject(parent), m_disassembler(nullptr)
+#define DOCKS_UPDATE_DELAY 150 // ms
+
+DisassemblerViewDocks::DisassemblerViewDocks(QObject *parent) : QObject(parent), m_disassembler(nullptr), m_referencesstale(false)
 {
+    m_updatetimer = new QTimer(this);
+    m_updatetimer->setSingleShot(true);
+    m_updatetimer->setInterval(DOCKS_UPDATE_DELAY);
+    connect(m_updatetimer, &QTimer::timeout, this, &DisassemblerViewDocks::updateDocks);
+
     m_dockfunctions = this->findDock("dockFunctions");
     m_dockcalltree = this->findDock("dockCallTree");
     m_dockreferences = this->findDock("dockReferences");
@@ -53,7 +60,6 @@ void DisassemblerViewDocks::initializeCallGraph(address_t address)
 
     m_dockcalltree->show();
     m_calltreemodel->initializeGraph(address);
-    m_calltreeview->expandToDepth(0);
 }
 
 void DisassemblerViewDocks::updateCallGraph()
@@ -71,9 +77,21 @@ void DisassemblerViewDocks::updateCallGraph()
     }
 
     m_calltreemodel->initializeGraph(item->address);
-    m_calltreeview->expandToDepth(0);
 }
 
+void DisassemblerViewDocks::scheduleUpdate() { m_updatetimer->start(); } // Restarted while the cursor keeps moving
+
+void DisassemblerViewDocks::updateDocks()
+{
+    this->updateCallGraph();
+    m_referencesstale = !this->isReferencesVisible();
+
+    if(!m_referencesstale)
+        emit referencesRequested();
+}
+
+bool DisassemblerViewDocks::isReferencesVisible() const { return m_dockreferences && m_dockreferences->isVisible() && !m_referencesview->visibleRegion().isEmpty(); }
+
 QDockWidget *DisassemblerViewDocks::findDock(const QString &objectname) const
 {
     QDockWidget* result = nullptr;
@@ -101,6 +119,12 @@ void DisassemblerViewDocks::createCallTreeModel()
     m_calltreeview->header()->setSectionResizeMode(2, QHeaderView::ResizeToContents);
 
     connect(m_calltreeview, &QTreeView::expanded, m_calltreemodel, &CallTreeModel::populateCallGraph);
+    connect(m_calltreemodel, &CallTreeModel::modelReset, m_calltreeview, [&]() { m_calltreeview->expandToDepth(0); }); // The root may show up later
+
+    connect(m_calltreemodel, &CallTreeModel::nodesExpanded, m_calltreeview, [&](const QModelIndexList& indexes) {
+        for(const QModelIndex& index : indexes)
+            m_calltreeview->expand(index);
+    });
     connect(m_dockcalltree, &QDockWidget::visibilityChanged, this, &DisassemblerViewDocks::updateCallGraph);
 }
 
@@ -132,6 +156,14 @@ void DisassemblerViewDocks::createReferencesModel()
     m_referencesview->setColumnHidden(0, true);
     m_referencesview->header()->setSectionResizeMode(1, QHeaderView::ResizeToContents);
     m_referencesview->header()->setSectionResizeMode(2, QHeaderView::Stretch);
+
+    connect(m_dockreferences, &QDockWidget::visibilityChanged, this, [&](bool visible) {
+        if(!visible || !m_referencesstale)
+            return;
+
+        m_referencesstale = false; // Skipped while hidden
+        emit referencesRequested();
+    });
 }
 
 void DisassemblerViewDocks::createListingMap()
@@ -6,6 +6,7 @@
 #include <QTabWidget>
 #include <QTableView>
 #include <QTreeView>
+#include <QTimer>
 #include <redasm/disassembler/disassemblerapi.h>
 #include "../../models/listingfiltermodel.h"
 #include "../../models/calltreemodel.h"
@@ -31,6 +32,10 @@ class DisassemblerViewDocks : public QObject
     public slots:
         void initializeCallGraph(address_t address);
         void updateCallGraph();
+        void scheduleUpdate();
+
+    private slots:
+        void updateDocks();
 
     private:
         QDockWidget* findDock(const QString& objectname) const;
@@ -38,6 +43,10 @@ class DisassemblerViewDocks : public QObject
         void createFunctionsModel();
         void createReferencesModel();
         void createListingMap();
+        bool isReferencesVisible() const;
+
+    signals:
+        void referencesRequested();
 
     private:
         std::shared_ptr<REDasm::DisassemblerAPI> m_disassembler;
@@ -48,6 +57,8 @@ class DisassemblerViewDocks : public QObject
         CallTreeModel* m_calltreemodel;
         ReferencesModel* m_referencesmodel;
         ListingMap* m_listingmap;
+        QTimer* m_updatetimer;
+        bool m_referencesstale;
 };
 
 #endif // DISASSEMBLERVIEWDOCKS_H
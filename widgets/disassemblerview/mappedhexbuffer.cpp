@@ -0,0 +1,26 @@
+#include "mappedhexbuffer.h"
+#include <algorithm>
+
+MappedHexBuffer::MappedHexBuffer(QObject *parent): QHexBuffer(parent), m_data(nullptr), m_length(0) { }
+uchar MappedHexBuffer::at(int idx) { return static_cast<uchar>(m_data[idx]); }
+void MappedHexBuffer::replace(int, const QByteArray &) { }
+int MappedHexBuffer::length() const { return m_length; }
+void MappedHexBuffer::insert(int, const QByteArray &) { }
+void MappedHexBuffer::remove(int, int) { }
+bool MappedHexBuffer::read(QIODevice *) { return false; } // Only memory is referenced
+
+void MappedHexBuffer::read(char *data, int size)
+{
+    m_data = data;
+    m_length = size;
+}
+
+QByteArray MappedHexBuffer::read(int offset, int length)
+{
+    if((offset < 0) || (offset >= m_length))
+        return QByteArray();
+
+    return QByteArray(m_data + offset, std::min(length, m_length - offset));
+}
+
+void MappedHexBuffer::write(QIODevice *device) { device->write(m_data, m_length); }
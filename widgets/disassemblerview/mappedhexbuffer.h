@@ -0,0 +1,29 @@
+#ifndef MAPPEDHEXBUFFER_H
+#define MAPPEDHEXBUFFER_H
+
+#include <QHexView/document/buffer/qhexbuffer.h>
+
+// Read only view over the loader's buffer: rows are copied out when they are painted,
+// the rest of the image is never touched (mapped pages stay on disk).
+class MappedHexBuffer : public QHexBuffer
+{
+    Q_OBJECT
+
+    public:
+        explicit MappedHexBuffer(QObject *parent = nullptr);
+        uchar at(int idx) override;
+        void replace(int offset, const QByteArray& data) override;
+        void read(char* data, int size) override;
+        int length() const override;
+        void insert(int offset, const QByteArray& data) override;
+        void remove(int offset, int length) override;
+        QByteArray read(int offset, int length) override;
+        bool read(QIODevice* device) override;
+        void write(QIODevice* device) override;
+
+    private:
+        const char* m_data;
+        int m_length;
+};
+
+#endif // MAPPEDHEXBUFFER_H
@@ -9,17 +9,14 @@
 #define DROP_SHADOW_SIZE  10
 #define BLOCK_MARGINS -BLOCK_MARGIN, 0, BLOCK_MARGIN, BLOCK_MARGIN
 
-DisassemblerBlockItem::DisassemblerBlockItem(const REDasm::Graphing::FunctionBasicBlock *fbb, const REDasm::DisassemblerPtr &disassembler, const REDasm::Graphing::Node &node, QWidget *parent) : GraphViewItem(node, parent), m_basicblock(fbb), m_disassembler(disassembler)
+DisassemblerBlockItem::DisassemblerBlockItem(const REDasm::Graphing::FunctionBasicBlock *fbb, const REDasm::DisassemblerPtr &disassembler, const REDasm::Graphing::Node &node, QWidget *parent) : GraphViewItem(node, parent), m_basicblock(fbb), m_disassembler(disassembler), m_dirty(true)
 {
     this->setupDocument();
 
     m_renderer = std::make_unique<ListingDocumentRenderer>(disassembler.get());
     m_renderer->setFirstVisibleLine(fbb->startidx);
     m_renderer->setFlags(ListingDocumentRenderer::HideSegmentName);
-    this->invalidate(false);
-
-    QFontMetricsF fm(m_document.defaultFont());
-    m_charheight = fm.height();
+    this->updateSize();
 
     EVENT_CONNECT(m_disassembler->document()->cursor(), positionChanged, this, [&]() {
         if(!m_basicblock->contains(m_disassembler->document()->cursor()->currentLine()))
@@ -73,21 +70,18 @@ void DisassemblerBlockItem::mouseMoveEvent(QMouseEvent *e)
 
 void DisassemblerBlockItem::invalidate(bool notify)
 {
-    m_document.clear();
-    m_renderer->render(m_basicblock->startidx, m_basicblock->count(), &m_document);
-    m_document.adjustSize();
-
+    m_dirty = true;
+    this->updateSize(); // Renames may change the longest line
     GraphViewItem::invalidate(notify);
 }
 
-QSize DisassemblerBlockItem::documentSize() const
-{
-    return { static_cast<int>(m_document.size().width()),
-             static_cast<int>(std::ceil(m_charheight * m_basicblock->count())) };
-}
+QSize DisassemblerBlockItem::documentSize() const { return m_size; }
 
 void DisassemblerBlockItem::render(QPainter *painter, size_t state)
 {
+    if(m_dirty)
+        this->updateDocument();
+
     QRect r(QPoint(0, 0), this->documentSize());
     r.adjust(BLOCK_MARGINS);
 
@@ -123,3 +117,19 @@ void DisassemblerBlockItem::setupDocument()
     m_document.setDefaultTextOption(textoption);
     m_document.setUndoRedoEnabled(false);
 }
+
+void DisassemblerBlockItem::updateSize()
+{
+    // Size is known without laying out any text, document is built on first render
+    QSizeF sz = m_renderer->measureLines(m_basicblock->startidx, m_basicblock->count());
+    m_size = QSize(static_cast<int>(std::ceil(sz.width() + (2 * m_document.documentMargin()))),
+                   static_cast<int>(std::ceil(sz.height())));
+}
+
+void DisassemblerBlockItem::updateDocument()
+{
+    m_document.clear();
+    m_renderer->render(m_basicblock->startidx, m_basicblock->count(), &m_document);
+    m_document.adjustSize();
+    m_dirty = false;
+}
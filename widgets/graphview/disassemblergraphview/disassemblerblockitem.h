@@ -32,6 +32,8 @@ class DisassemblerBlockItem : public GraphViewItem
     private:
         QSize documentSize() const;
         void setupDocument();
+        void updateSize();
+        void updateDocument();
 
     signals:
         void followRequested(const QPointF& localpos);
@@ -41,7 +43,8 @@ class DisassemblerBlockItem : public GraphViewItem
         std::unique_ptr<ListingDocumentRenderer> m_renderer;
         REDasm::DisassemblerPtr m_disassembler;
         QTextDocument m_document;
-        qreal m_charheight;
+        QSize m_size;
+        bool m_dirty;
         QFont m_font;
 };
 
@@ -1,12 +1,16 @@
 #include "disassemblergraphview.h"
 #include "../../../models/disassemblermodel.h"
 #include "../../../redasmsettings.h"
+#include "../export/graphviewexporter.h"
 #include <redasm/graph/layout/layeredlayout.h>
 #include <QResizeEvent>
 #include <QScrollBar>
 #include <QPainter>
 #include <QDebug>
 #include <QAction>
+#include <QFileDialog>
+#include <QFutureWatcher>
+#include <QtConcurrent>
 
 DisassemblerGraphView::DisassemblerGraphView(QWidget *parent): GraphView(parent), m_currentfunction(nullptr)
 {
@@ -20,6 +24,7 @@ DisassemblerGraphView::DisassemblerGraphView(QWidget *parent): GraphView(parent)
     connect(m_disassembleractions, &DisassemblerActions::switchToHexDump, this, &DisassemblerGraphView::switchToHexDump);
     connect(m_disassembleractions, &DisassemblerActions::callGraphRequested, this, &DisassemblerGraphView::callGraphRequested);
     connect(m_disassembleractions, &DisassemblerActions::itemInformationRequested, this, &DisassemblerGraphView::itemInformationRequested);
+    connect(m_disassembleractions, &DisassemblerActions::exportGraphRequested, this, &DisassemblerGraphView::exportGraphAs);
 }
 
 DisassemblerGraphView::~DisassemblerGraphView()
@@ -47,6 +52,20 @@ void DisassemblerGraphView::setDisassembler(const REDasm::DisassemblerPtr &disas
 
 bool DisassemblerGraphView::isCursorInGraph() const { return this->itemFromCurrentLine() != nullptr; }
 
+bool DisassemblerGraphView::exportGraph(const QString &filename)
+{
+    if(!this->graph())
+        return false;
+
+    GraphViewExporter exporter(this->sceneSnapshot(), this->sceneRect());
+
+    if(exporter.exportTo(filename))
+        return true;
+
+    REDasm::log(exporter.lastError().toStdString());
+    return false;
+}
+
 std::string DisassemblerGraphView::currentWord()
 {
     if(!this->selectedItem())
@@ -103,6 +122,42 @@ void DisassemblerGraphView::onMenuRequested()
     m_disassembleractions->popup(QCursor::pos());
 }
 
+void DisassemblerGraphView::exportGraphAs()
+{
+    if(!this->graph())
+        return;
+
+    QString filename = QFileDialog::getSaveFileName(this, "Export Graph", QString(), "PNG Image (*.png);;SVG Image (*.svg)");
+
+    if(filename.isEmpty())
+        return;
+
+    // Pictures are recorded here, workers only replay them
+    auto exporter = std::make_shared<GraphViewExporter>(this->sceneSnapshot(), this->sceneRect());
+
+    exporter->setProgressCallback([filename](int current, int total) {
+        REDasm::status("Exporting " + filename.toStdString() + " (" + std::to_string((current * 100) / total) + "%)");
+    });
+
+    auto* watcher = new QFutureWatcher<QString>(this);
+
+    connect(watcher, &QFutureWatcher<QString>::finished, this, [watcher, filename]() {
+        QString error = watcher->result();
+
+        if(error.isEmpty())
+            REDasm::log("Graph exported to " + REDasm::quoted(filename.toStdString()));
+        else
+            REDasm::log(error.toStdString());
+
+        REDasm::status(std::string());
+        watcher->deleteLater();
+    });
+
+    watcher->setFuture(QtConcurrent::run([exporter, filename]() -> QString {
+        return exporter->exportTo(filename) ? QString() : exporter->lastError();
+    }));
+}
+
 void DisassemblerGraphView::goTo(address_t address)
 {
     auto& document = m_disassembler->document();
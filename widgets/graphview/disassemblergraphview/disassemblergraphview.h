@@ -16,6 +16,7 @@ class DisassemblerGraphView : public GraphView
         virtual ~DisassemblerGraphView();
         void setDisassembler(const REDasm::DisassemblerPtr &disassembler) override;
         bool isCursorInGraph() const;
+        bool exportGraph(const QString& filename);
         std::string currentWord();
 
     public slots:
@@ -41,6 +42,7 @@ class DisassemblerGraphView : public GraphView
     private slots:
         void onFollowRequested(const QPointF &localpos);
         void onMenuRequested();
+        void exportGraphAs();
 
     signals:
         void switchView();
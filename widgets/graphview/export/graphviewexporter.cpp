@@ -0,0 +1,157 @@
+#include "graphviewexporter.h"
+#include "pngstreamwriter.h"
+#include "svgstreamdevice.h"
+#include <QtConcurrent>
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QPainter>
+#include <limits>
+#include <cmath>
+
+#define EXPORT_BAND_BUDGET (32 * 1024 * 1024) // Bytes of pixel data per band
+#define EXPORT_TILE_WIDTH  1024
+#define EXPORT_MIN_BAND    16
+#define EXPORT_MAX_BAND    512
+#define EXPORT_MAX_BYTES   (256 * 1024 * 1024)             // Bytes of the thinnest band, whatever the width
+#define EXPORT_MAX_WIDTH   (EXPORT_MAX_BYTES / (EXPORT_MIN_BAND * 4))
+#define EXPORT_MAX_HEIGHT  (0x7FFFFFFF - EXPORT_MAX_BAND)  // PNG's limit
+
+GraphViewExporter::GraphViewExporter(const GraphViewSnapshot &scene, const QRect &scenerect, qreal scale): m_scene(scene), m_scenerect(scenerect), m_scale(scale) { }
+void GraphViewExporter::setProgressCallback(const GraphViewExporter::ProgressCallback &cb) { m_progress = cb; }
+
+bool GraphViewExporter::exportTo(const QString &filename)
+{
+    QString suffix = QFileInfo(filename).suffix().toLower();
+
+    if(suffix == "svg")
+        return this->exportSvg(filename);
+    if(suffix == "png")
+        return this->exportPng(filename);
+
+    return this->fail("Unsupported export format: " + filename);
+}
+
+bool GraphViewExporter::exportPng(const QString &filename)
+{
+    QSizeF imagesize = this->imageSize();
+
+    if(imagesize.isEmpty())
+        return this->fail("Nothing to export");
+
+    if((imagesize.width() > EXPORT_MAX_WIDTH) || (imagesize.height() > EXPORT_MAX_HEIGHT))
+    {
+        return this->fail(QString("Graph is too large for a PNG (%1x%2 pixels), export it as SVG or at a lower scale").arg(QString::number(imagesize.width(), 'f', 0),
+                                                                                                                            QString::number(imagesize.height(), 'f', 0)));
+    }
+
+    QSize size = GraphViewExporter::pixelSize(imagesize);
+
+    QSaveFile file(filename);
+
+    if(!file.open(QIODevice::WriteOnly))
+        return this->fail("Cannot write " + filename + ": " + file.errorString());
+
+    PngStreamWriter png(&file);
+
+    if(!png.begin(size.width(), size.height()))
+        return this->fail("Cannot write " + filename + ": " + file.errorString());
+
+    QPoint origin = QPointF(m_scenerect.topLeft() * m_scale).toPoint();
+    int bandheight = qBound(EXPORT_MIN_BAND, EXPORT_BAND_BUDGET / (size.width() * 4), EXPORT_MAX_BAND);
+
+    for(int y = 0; y < size.height(); y += bandheight)
+    {
+        int h = std::min(bandheight, size.height() - y);
+        QVector<QRect> tiles;
+
+        for(int x = 0; x < size.width(); x += EXPORT_TILE_WIDTH)
+            tiles.push_back(QRect(origin.x() + x, origin.y() + y, std::min(EXPORT_TILE_WIDTH, size.width() - x), h));
+
+        QVector<QImage> images = QtConcurrent::blockingMapped< QVector<QImage> >(tiles, [&](const QRect& tile) -> QImage {
+            QRect graphrect(static_cast<int>(std::floor(tile.x() / m_scale)), static_cast<int>(std::floor(tile.y() / m_scale)),
+                            static_cast<int>(std::ceil(tile.width() / m_scale)) + 1, static_cast<int>(std::ceil(tile.height() / m_scale)) + 1);
+
+            return this->crop(graphrect).renderImage(tile, m_scale);
+        });
+
+        QImage band(size.width(), h, QImage::Format_RGB32);
+
+        if(band.isNull())
+            return this->fail(QString("Cannot allocate a %1x%2 band for the PNG, export it at a lower scale").arg(size.width()).arg(h));
+
+        QPainter painter(&band);
+
+        for(int i = 0; i < tiles.size(); i++)
+        {
+            if(images[i].isNull())
+                return this->fail(QString("Cannot allocate a %1x%2 tile for the PNG").arg(tiles[i].width()).arg(tiles[i].height()));
+
+            painter.drawImage(tiles[i].x() - origin.x(), 0, images[i]);
+        }
+
+        painter.end();
+
+        if(!png.writeRows(band))
+            return this->fail("Cannot write " + filename + ": " + file.errorString());
+
+        if(m_progress)
+            m_progress(y + h, size.height());
+    }
+
+    if(!png.end() || !file.commit())
+        return this->fail("Cannot write " + filename + ": " + file.errorString());
+
+    return true;
+}
+
+bool GraphViewExporter::exportSvg(const QString &filename)
+{
+    QSizeF imagesize = this->imageSize();
+
+    if(imagesize.isEmpty())
+        return this->fail("Nothing to export");
+
+    QSize size = GraphViewExporter::pixelSize(imagesize); // Vectors have no pixel limits, just the viewport's size
+
+    QSaveFile file(filename);
+
+    if(!file.open(QIODevice::WriteOnly))
+        return this->fail("Cannot write " + filename + ": " + file.errorString());
+
+    SvgStreamDevice device(&file, size);
+    QPainter painter(&device);
+    painter.fillRect(QRect(QPoint(0, 0), size), m_scene.background);
+    painter.translate(-m_scenerect.topLeft() * m_scale);
+    painter.scale(m_scale, m_scale);
+    m_scene.render(&painter);
+
+    if(!painter.end() || !file.commit())
+        return this->fail("Cannot write " + filename + ": " + file.errorString());
+
+    if(m_progress)
+        m_progress(size.height(), size.height());
+
+    return true;
+}
+
+GraphViewSnapshot GraphViewExporter::crop(const QRect &graphrect) const
+{
+    GraphViewSnapshot snapshot = m_scene;
+    snapshot.blocks.clear();
+
+    for(const GraphViewSnapshot::Block& block : m_scene.blocks)
+    {
+        if(block.rect.intersects(graphrect))
+            snapshot.blocks.push_back(block);
+    }
+
+    return snapshot;
+}
+
+QSizeF GraphViewExporter::imageSize() const { return QSizeF(m_scenerect.size()) * m_scale; }
+
+QSize GraphViewExporter::pixelSize(const QSizeF &size)
+{
+    return QSize(static_cast<int>(std::min<qreal>(std::ceil(size.width()), std::numeric_limits<int>::max())),
+                 static_cast<int>(std::min<qreal>(std::ceil(size.height()), std::numeric_limits<int>::max())));
+}
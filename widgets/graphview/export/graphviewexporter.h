@@ -0,0 +1,38 @@
+#ifndef GRAPHVIEWEXPORTER_H
+#define GRAPHVIEWEXPORTER_H
+
+#include <functional>
+#include <QString>
+#include "../graphviewsnapshot.h"
+#include "../../../lasterror.h"
+
+// Renders a whole graph scene to disk without ever holding the full image:
+// PNGs are produced one horizontal band at a time (tiles of a band are rendered in parallel),
+// SVGs are streamed while the scene is painted.
+class GraphViewExporter : public LastError
+{
+    public:
+        typedef std::function<void(int, int)> ProgressCallback;
+
+    public:
+        GraphViewExporter(const GraphViewSnapshot& scene, const QRect& scenerect, qreal scale = 1.0);
+        void setProgressCallback(const ProgressCallback& cb);
+        bool exportTo(const QString& filename);
+        bool exportPng(const QString& filename);
+        bool exportSvg(const QString& filename);
+
+    private:
+        GraphViewSnapshot crop(const QRect& graphrect) const;
+        QSizeF imageSize() const;
+
+    private:
+        static QSize pixelSize(const QSizeF& size);
+
+    private:
+        GraphViewSnapshot m_scene;
+        QRect m_scenerect;
+        qreal m_scale;
+        ProgressCallback m_progress;
+};
+
+#endif // GRAPHVIEWEXPORTER_H
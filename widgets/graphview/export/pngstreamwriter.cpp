@@ -0,0 +1,126 @@
+#include "pngstreamwriter.h"
+#include <QtEndian>
+#include <zlib.h>
+
+#define PNG_SIGNATURE      "\x89PNG\r\n\x1a\n"
+#define PNG_FILTER_SUB     1
+#define PNG_BPP            3 // RGB888
+#define PNG_LEVEL          6
+#define IDAT_SIZE          65536
+
+PngStreamWriter::PngStreamWriter(QIODevice *device): m_device(device), m_stream(new z_stream()), m_streaming(false), m_width(0), m_height(0), m_rows(0) { }
+PngStreamWriter::~PngStreamWriter() { if(m_streaming) deflateEnd(m_stream.get()); }
+
+bool PngStreamWriter::begin(int width, int height)
+{
+    if((width <= 0) || (height <= 0) || m_streaming)
+        return false;
+
+    m_width = width;
+    m_height = height;
+    m_rows = 0;
+    m_row = QByteArray((width * PNG_BPP) + 1, 0);
+    m_out = QByteArray(IDAT_SIZE, 0);
+
+    if(deflateInit(m_stream.get(), PNG_LEVEL) != Z_OK)
+        return false;
+
+    m_streaming = true;
+    m_stream->next_out = reinterpret_cast<Bytef*>(m_out.data());
+    m_stream->avail_out = IDAT_SIZE;
+
+    if(m_device->write(PNG_SIGNATURE, 8) != 8)
+        return false;
+
+    QByteArray ihdr(13, 0);
+    qToBigEndian<quint32>(static_cast<quint32>(width), reinterpret_cast<uchar*>(ihdr.data()));
+    qToBigEndian<quint32>(static_cast<quint32>(height), reinterpret_cast<uchar*>(ihdr.data() + 4));
+    ihdr[8] = 8; // Bit depth
+    ihdr[9] = 2; // Truecolor
+
+    return this->writeChunk("IHDR", ihdr);
+}
+
+bool PngStreamWriter::writeRows(const QImage &image)
+{
+    if(!m_streaming || (image.width() != m_width) || ((m_rows + image.height()) > m_height))
+        return false;
+
+    QImage rgb = image.convertToFormat(QImage::Format_RGB888);
+    uchar* row = reinterpret_cast<uchar*>(m_row.data());
+    int rowsize = m_width * PNG_BPP;
+
+    for(int y = 0; y < rgb.height(); y++, m_rows++)
+    {
+        const uchar* pixels = rgb.constScanLine(y);
+        row[0] = PNG_FILTER_SUB; // Flat areas become runs of zeros
+
+        for(int i = 0; i < rowsize; i++)
+            row[i + 1] = pixels[i] - ((i >= PNG_BPP) ? pixels[i - PNG_BPP] : 0);
+
+        if(!this->compress(row, rowsize + 1, Z_NO_FLUSH))
+            return false;
+    }
+
+    return true;
+}
+
+bool PngStreamWriter::end()
+{
+    if(!m_streaming || (m_rows != m_height) || !this->compress(nullptr, 0, Z_FINISH) || !this->flushData())
+        return false;
+
+    deflateEnd(m_stream.get());
+    m_streaming = false;
+    return this->writeChunk("IEND", QByteArray());
+}
+
+bool PngStreamWriter::compress(const uchar *data, int len, int flush)
+{
+    m_stream->next_in = const_cast<Bytef*>(data);
+    m_stream->avail_in = static_cast<uInt>(len);
+
+    for( ; ; )
+    {
+        int res = deflate(m_stream.get(), flush);
+
+        if((res != Z_OK) && (res != Z_STREAM_END) && (res != Z_BUF_ERROR)) // Z_BUF_ERROR: nothing to do
+            return false;
+
+        if(!m_stream->avail_out) // IDAT chunks are written when full
+        {
+            if(!this->flushData())
+                return false;
+
+            continue;
+        }
+
+        if((flush == Z_FINISH) ? (res == Z_STREAM_END) : !m_stream->avail_in)
+            return true;
+    }
+}
+
+bool PngStreamWriter::writeChunk(const char *type, const QByteArray &data)
+{
+    QByteArray chunk(4, 0);
+    qToBigEndian<quint32>(static_cast<quint32>(data.size()), reinterpret_cast<uchar*>(chunk.data()));
+
+    QByteArray body = QByteArray(type, 4) + data;
+    QByteArray crc(4, 0);
+    qToBigEndian<quint32>(static_cast<quint32>(crc32(0, reinterpret_cast<const Bytef*>(body.constData()), static_cast<uInt>(body.size()))), reinterpret_cast<uchar*>(crc.data()));
+
+    chunk += body + crc;
+    return m_device->write(chunk) == chunk.size();
+}
+
+bool PngStreamWriter::flushData()
+{
+    int size = IDAT_SIZE - static_cast<int>(m_stream->avail_out);
+
+    if(!size)
+        return true;
+
+    m_stream->next_out = reinterpret_cast<Bytef*>(m_out.data());
+    m_stream->avail_out = IDAT_SIZE;
+    return this->writeChunk("IDAT", m_out.left(size));
+}
@@ -0,0 +1,35 @@
+#ifndef PNGSTREAMWRITER_H
+#define PNGSTREAMWRITER_H
+
+#include <QIODevice>
+#include <QByteArray>
+#include <QImage>
+#include <memory>
+
+struct z_stream_s;
+
+// Writes a RGB PNG one scanline at a time through zlib's streaming deflate:
+// memory use doesn't depend on the size of the image.
+class PngStreamWriter
+{
+    public:
+        PngStreamWriter(QIODevice* device);
+        ~PngStreamWriter();
+        bool begin(int width, int height);
+        bool writeRows(const QImage& image);
+        bool end();
+
+    private:
+        bool compress(const uchar* data, int len, int flush);
+        bool writeChunk(const char* type, const QByteArray& data);
+        bool flushData();
+
+    private:
+        QIODevice* m_device;
+        std::unique_ptr<z_stream_s> m_stream;
+        QByteArray m_row, m_out;
+        bool m_streaming;
+        int m_width, m_height, m_rows;
+};
+
+#endif // PNGSTREAMWRITER_H
@@ -0,0 +1,194 @@
+#include "svgstreamdevice.h"
+#include <QPainterPath>
+#include <QBuffer>
+#include <QPixmap>
+#include <climits>
+
+#define SVG_DPI 96
+
+#define SVG_FEATURES QPaintEngine::PaintEngineFeatures(QPaintEngine::AllFeatures & ~QPaintEngine::PatternBrush      \
+                                                                             & ~QPaintEngine::PerspectiveTransform \
+                                                                             & ~QPaintEngine::ConicalGradientFill  \
+                                                                             & ~QPaintEngine::PorterDuff)
+
+SvgStreamPaintEngine::SvgStreamPaintEngine(QIODevice *device, const QSize &size): QPaintEngine(SVG_FEATURES), m_stream(device), m_size(size) { m_stream.setCodec("UTF-8"); }
+
+bool SvgStreamPaintEngine::begin(QPaintDevice*)
+{
+    m_stream << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+             << "<svg xmlns=\"http://www.w3.org/2000/svg\" xmlns:xlink=\"http://www.w3.org/1999/xlink\" version=\"1.1\" xml:space=\"preserve\" "
+             << "width=\"" << m_size.width() << "\" height=\"" << m_size.height() << "\" "
+             << "viewBox=\"0 0 " << m_size.width() << " " << m_size.height() << "\">\n";
+
+    return m_stream.status() == QTextStream::Ok;
+}
+
+bool SvgStreamPaintEngine::end()
+{
+    m_stream << "</svg>\n";
+    m_stream.flush();
+    return m_stream.status() == QTextStream::Ok;
+}
+
+void SvgStreamPaintEngine::updateState(const QPaintEngineState &state)
+{
+    if(state.state() & QPaintEngine::DirtyPen)
+        m_pen = state.pen();
+    if(state.state() & QPaintEngine::DirtyBrush)
+        m_brush = state.brush();
+    if(state.state() & QPaintEngine::DirtyTransform)
+        m_transform = state.transform();
+}
+
+void SvgStreamPaintEngine::drawRects(const QRectF *rects, int rectCount)
+{
+    for(int i = 0; i < rectCount; i++)
+    {
+        const QRectF& r = rects[i];
+        m_stream << "<rect x=\"" << r.x() << "\" y=\"" << r.y() << "\" width=\"" << r.width() << "\" height=\"" << r.height() << "\""
+                 << this->penStyle() << this->brushStyle() << this->transformStyle() << "/>\n";
+    }
+}
+
+void SvgStreamPaintEngine::drawLines(const QLineF *lines, int lineCount)
+{
+    if(m_pen.style() == Qt::NoPen)
+        return;
+
+    for(int i = 0; i < lineCount; i++)
+    {
+        const QLineF& l = lines[i];
+        m_stream << "<line x1=\"" << l.x1() << "\" y1=\"" << l.y1() << "\" x2=\"" << l.x2() << "\" y2=\"" << l.y2() << "\""
+                 << this->penStyle() << this->transformStyle() << "/>\n";
+    }
+}
+
+void SvgStreamPaintEngine::drawPolygon(const QPointF *points, int pointCount, QPaintEngine::PolygonDrawMode mode)
+{
+    m_stream << ((mode == QPaintEngine::PolylineMode) ? "<polyline" : "<polygon") << " points=\"";
+
+    for(int i = 0; i < pointCount; i++)
+        m_stream << (i ? " " : "") << points[i].x() << "," << points[i].y();
+
+    m_stream << "\"" << this->penStyle();
+
+    if(mode == QPaintEngine::PolylineMode)
+        m_stream << " fill=\"none\"";
+    else
+        m_stream << this->brushStyle() << " fill-rule=\"" << ((mode == QPaintEngine::OddEvenMode) ? "evenodd" : "nonzero") << "\"";
+
+    m_stream << this->transformStyle() << "/>\n";
+}
+
+void SvgStreamPaintEngine::drawPath(const QPainterPath &path)
+{
+    bool oddeven = path.fillRule() == Qt::OddEvenFill;
+
+    for(const QPolygonF& polygon : path.toSubpathPolygons())
+        this->drawPolygon(polygon.constData(), polygon.size(), oddeven ? QPaintEngine::OddEvenMode : QPaintEngine::WindingMode);
+}
+
+void SvgStreamPaintEngine::drawTextItem(const QPointF &p, const QTextItem &textItem)
+{
+    QFont font = textItem.font();
+    qreal size = (font.pixelSize() > 0) ? font.pixelSize() : ((font.pointSizeF() * SVG_DPI) / 72.0);
+    QColor c = m_pen.color();
+
+    m_stream << "<text x=\"" << p.x() << "\" y=\"" << p.y() << "\" font-family=\"" << font.family().toHtmlEscaped() << "\" font-size=\"" << size << "\"";
+
+    if(font.bold())
+        m_stream << " font-weight=\"bold\"";
+    if(font.italic())
+        m_stream << " font-style=\"italic\"";
+
+    m_stream << " fill=\"" << c.name() << "\"";
+
+    if(c.alpha() != 255)
+        m_stream << " fill-opacity=\"" << c.alphaF() << "\"";
+
+    m_stream << this->transformStyle() << ">" << textItem.text().toHtmlEscaped() << "</text>\n";
+}
+
+void SvgStreamPaintEngine::drawPixmap(const QRectF &r, const QPixmap &pm, const QRectF &sr)
+{
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    pm.copy(sr.toAlignedRect()).save(&buffer, "PNG");
+
+    m_stream << "<image x=\"" << r.x() << "\" y=\"" << r.y() << "\" width=\"" << r.width() << "\" height=\"" << r.height() << "\""
+             << " xlink:href=\"data:image/png;base64," << data.toBase64() << "\"" << this->transformStyle() << "/>\n";
+}
+
+QPaintEngine::Type SvgStreamPaintEngine::type() const { return QPaintEngine::User; }
+
+QString SvgStreamPaintEngine::penStyle() const
+{
+    if(m_pen.style() == Qt::NoPen)
+        return " stroke=\"none\"";
+
+    QColor c = m_pen.color();
+    qreal width = m_pen.widthF() > 0 ? m_pen.widthF() : 1.0;
+    QString s = QString(" stroke=\"%1\" stroke-width=\"%2\"").arg(c.name()).arg(width);
+
+    if(c.alpha() != 255)
+        s += QString(" stroke-opacity=\"%1\"").arg(c.alphaF());
+    if(m_pen.isCosmetic())
+        s += " vector-effect=\"non-scaling-stroke\"";
+    if(m_pen.style() == Qt::DashLine)
+        s += QString(" stroke-dasharray=\"%1,%2\"").arg(width * 4).arg(width * 2);
+    else if(m_pen.style() == Qt::DotLine)
+        s += QString(" stroke-dasharray=\"%1,%1\"").arg(width);
+
+    return s;
+}
+
+QString SvgStreamPaintEngine::brushStyle() const
+{
+    if(m_brush.style() == Qt::NoBrush)
+        return " fill=\"none\"";
+
+    QColor c = m_brush.color(); // Gradients and patterns are flattened to their base colour
+    QString s = QString(" fill=\"%1\"").arg(c.name());
+
+    if(c.alpha() != 255)
+        s += QString(" fill-opacity=\"%1\"").arg(c.alphaF());
+
+    return s;
+}
+
+QString SvgStreamPaintEngine::transformStyle() const
+{
+    if(m_transform.isIdentity())
+        return QString();
+
+    return QString(" transform=\"matrix(%1 %2 %3 %4 %5 %6)\"").arg(m_transform.m11()).arg(m_transform.m12())
+                                                              .arg(m_transform.m21()).arg(m_transform.m22())
+                                                              .arg(m_transform.dx()).arg(m_transform.dy());
+}
+
+SvgStreamDevice::SvgStreamDevice(QIODevice *device, const QSize &size): QPaintDevice(), m_engine(new SvgStreamPaintEngine(device, size)), m_size(size) { }
+SvgStreamDevice::~SvgStreamDevice() { delete m_engine; }
+QPaintEngine *SvgStreamDevice::paintEngine() const { return m_engine; }
+
+int SvgStreamDevice::metric(QPaintDevice::PaintDeviceMetric metric) const
+{
+    switch(metric)
+    {
+        case QPaintDevice::PdmWidth: return m_size.width();
+        case QPaintDevice::PdmHeight: return m_size.height();
+        case QPaintDevice::PdmWidthMM: return qRound(m_size.width() * 25.4 / SVG_DPI);
+        case QPaintDevice::PdmHeightMM: return qRound(m_size.height() * 25.4 / SVG_DPI);
+        case QPaintDevice::PdmNumColors: return INT_MAX;
+        case QPaintDevice::PdmDepth: return 32;
+        case QPaintDevice::PdmDpiX:
+        case QPaintDevice::PdmDpiY:
+        case QPaintDevice::PdmPhysicalDpiX:
+        case QPaintDevice::PdmPhysicalDpiY: return SVG_DPI;
+        case QPaintDevice::PdmDevicePixelRatio: return 1;
+        case QPaintDevice::PdmDevicePixelRatioScaled: return static_cast<int>(QPaintDevice::devicePixelRatioFScale());
+        default: break;
+    }
+
+    return 0;
+}
@@ -0,0 +1,54 @@
+#ifndef SVGSTREAMDEVICE_H
+#define SVGSTREAMDEVICE_H
+
+#include <QPaintDevice>
+#include <QPaintEngine>
+#include <QTextStream>
+#include <QIODevice>
+
+// Unlike QSvgGenerator, every primitive is written to the output device as soon as
+// it's painted: nothing is buffered, so memory doesn't grow with the drawing.
+class SvgStreamPaintEngine : public QPaintEngine
+{
+    public:
+        SvgStreamPaintEngine(QIODevice* device, const QSize& size);
+        bool begin(QPaintDevice*) override;
+        bool end() override;
+        void updateState(const QPaintEngineState& state) override;
+        void drawRects(const QRectF* rects, int rectCount) override;
+        void drawLines(const QLineF* lines, int lineCount) override;
+        void drawPolygon(const QPointF* points, int pointCount, PolygonDrawMode mode) override;
+        void drawPath(const QPainterPath& path) override;
+        void drawTextItem(const QPointF& p, const QTextItem& textItem) override;
+        void drawPixmap(const QRectF& r, const QPixmap& pm, const QRectF& sr) override;
+        Type type() const override;
+
+    private:
+        QString penStyle() const;
+        QString brushStyle() const;
+        QString transformStyle() const;
+
+    private:
+        QTextStream m_stream;
+        QSize m_size;
+        QPen m_pen;
+        QBrush m_brush;
+        QTransform m_transform;
+};
+
+class SvgStreamDevice : public QPaintDevice
+{
+    public:
+        SvgStreamDevice(QIODevice* device, const QSize& size);
+        ~SvgStreamDevice();
+        QPaintEngine* paintEngine() const override;
+
+    protected:
+        int metric(PaintDeviceMetric metric) const override;
+
+    private:
+        SvgStreamPaintEngine* m_engine;
+        QSize m_size;
+};
+
+#endif // SVGSTREAMDEVICE_H
@@ -3,6 +3,12 @@
 #include <QScrollBar>
 #include <QPainter>
 #include <QDebug>
+#include <cmath>
+
+#define ITEM_SCENE_MARGIN 16 // Borders and drop shadows are painted outside the item's rect
+#define MINIMAP_MARGIN    10
+
+static inline int tileIndex(int v) { return static_cast<int>(std::floor(v / static_cast<qreal>(GRAPHVIEW_TILE_SIZE))); }
 
 GraphView::GraphView(QWidget *parent): QAbstractScrollArea(parent), m_disassembler(nullptr), m_selecteditem(nullptr), m_focusonselection(false)
 {
@@ -21,6 +27,20 @@ GraphView::GraphView(QWidget *parent): QAbstractScrollArea(parent), m_disassembl
     this->verticalScrollBar()->setSingleStep(this->fontMetrics().height());
     this->setAutoFillBackground(true);
     this->setPalette(palette);
+
+    m_tiles = new GraphViewTileCache(this);
+
+    connect(m_tiles, &GraphViewTileCache::tileReady, this, [&](const GraphViewTileKey& key) {
+        if(key.zoom != GraphViewTileCache::zoomKey(m_scalefactor))
+            return;
+
+        this->viewport()->update(GraphViewTileCache::tileRect(key).translated(this->renderTranslation()));
+    });
+
+    m_minimap = new GraphViewMinimap(this->viewport());
+    connect(m_minimap, &GraphViewMinimap::centerRequested, this, &GraphView::centerOn);
+    connect(this->horizontalScrollBar(), &QScrollBar::valueChanged, this, &GraphView::updateMinimapRect);
+    connect(this->verticalScrollBar(), &QScrollBar::valueChanged, this, &GraphView::updateMinimapRect);
 }
 
 void GraphView::setDisassembler(const REDasm::DisassemblerPtr& disassembler) { m_disassembler = disassembler; }
@@ -31,8 +51,12 @@ void GraphView::setGraph(REDasm::Graphing::Graph *graph)
     m_scalefactor = m_scaleboost = 1.0;
     qDeleteAll(m_items);
     m_items.clear();
-    m_lines.clear();
-    m_arrows.clear();
+    m_edges.clear();
+    m_highlightededges.clear();
+    m_edgeranges.clear();
+    m_pictures.clear();
+    m_tiles->clear();
+    m_minimap->clear();
 
     m_graph = graph;
     this->computeLayout();
@@ -45,8 +69,10 @@ void GraphView::setSelectedBlock(GraphViewItem *item)
         if(gvi != item)
             continue;
 
+        GraphViewItem* olditem = m_selecteditem;
         bool changed = (m_selecteditem != item);
         m_selecteditem = item;
+        this->invalidateSelection(olditem);
         this->focusSelectedBlock();
         if (changed)
             this->selectedItemChangedEvent();
@@ -64,6 +90,12 @@ void GraphView::focusSelectedBlock()
         this->focusBlock(m_selecteditem);
 }
 
+void GraphView::centerOn(const QPointF &scenepos)
+{
+    this->horizontalScrollBar()->setValue(qRound(m_renderoffset.x() + (scenepos.x() * m_scalefactor) - (this->viewport()->width() / 2.0)));
+    this->verticalScrollBar()->setValue(qRound(m_renderoffset.y() + (scenepos.y() * m_scalefactor) - (this->viewport()->height() / 2.0)));
+}
+
 void GraphView::focusBlock(const GraphViewItem *item, bool force)
 {
     // Don't update the view for blocks that are already fully in view
@@ -196,62 +228,18 @@ void GraphView::resizeEvent(QResizeEvent *e) { this->adjustSize(e->size().width(
 
 void GraphView::paintEvent(QPaintEvent *e)
 {
-    QPoint translation = { m_renderoffset.x() - this->horizontalScrollBar()->value(),
-                           m_renderoffset.y() - this->verticalScrollBar()->value() };
-
+    QPoint translation = this->renderTranslation();
     QPainter painter(this->viewport());
-    painter.translate(translation);
-    painter.scale(m_scalefactor, m_scalefactor);
-
-    QRect vpr(this->viewport()->rect().topLeft(), this->viewport()->rect().bottomRight() - QPoint(1, 1));
-
-    // Adjust imaginary viewport rect at new zoom level
-    vpr.setWidth(vpr.width() / m_scalefactor);
-    vpr.setHeight(vpr.height() / m_scalefactor);
-    vpr.translate(-translation.x() / m_scalefactor, -translation.y() / m_scalefactor);
-
-    // Render edges
-    painter.save();
-
-    for(auto it = m_lines.begin(); it != m_lines.end(); it++)
-    {
-        QColor c(QString::fromStdString(m_graph->color(it->first)));
-        QPen pen(c);
+    this->renderTiles(&painter, translation, e->rect());
 
-        if(m_selecteditem && ((it->first.source == m_selecteditem->node()) || (it->first.target == m_selecteditem->node())))
-        {
-            pen.setWidthF(2.0 / m_scalefactor);
-        }
-        else
-        {
-            pen.setWidthF(1.0 / m_scalefactor);
-            pen.setStyle(m_selecteditem ? Qt::DashLine : Qt::SolidLine);
-        }
-
-        painter.setPen(pen);
-        painter.setBrush(c);
-        painter.drawLines(it->second);
-
-        pen.setStyle(Qt::SolidLine);
-        painter.setPen(pen);
-        painter.drawConvexPolygon(m_arrows[it->first]);
-    }
-
-    painter.restore();
-
-    // Render nodes
-    for(auto* item : m_items)
-    {
-        if(!vpr.intersects(item->rect())) // Ignore blocks that are not in view
-            continue;
-
-        size_t itemstate = GraphViewItem::None;
-
-        if(m_selecteditem == item)
-            itemstate |= GraphViewItem::Selected;
+    if(!m_selecteditem)
+        return;
 
-        item->render(&painter, itemstate);
-    }
+    // Selected block is rendered live on top of the tiles: cursor blinking never touches the cache
+    painter.translate(translation);
+    painter.scale(m_scalefactor, m_scalefactor);
+    m_highlightededges.render(&painter, GraphViewEdges::Highlighted);
+    m_selecteditem->render(&painter, GraphViewItem::Selected);
 }
 
 void GraphView::showEvent(QShowEvent *e)
@@ -272,17 +260,26 @@ void GraphView::selectedItemChangedEvent()
 
 void GraphView::computeLayout()
 {
+    m_scenerect = QRect();
+
     for(const auto& n : m_graph->nodes())
     {
-        m_items[n]->move(QPoint(m_graph->x(n), m_graph->y(n)));
-        connect(m_items[n], &GraphViewItem::invalidated, this->viewport(), [&]() { this->viewport()->update(); });
+        GraphViewItem* item = m_items[n];
+        item->move(QPoint(m_graph->x(n), m_graph->y(n)));
+        m_scenerect |= this->itemSceneRect(item);
+
+        connect(item, &GraphViewItem::invalidated, this, [=]() {
+            if(item != m_selecteditem) // Selected item is not served from cache
+                this->invalidateItem(item);
+
+            this->viewport()->update();
+        });
     }
 
     for(const auto& e : m_graph->edges())
-    {
-        this->precomputeLine(e);
-        this->precomputeArrow(e);
-    }
+        this->precomputeEdge(e);
+
+    this->updateHighlightedEdges();
 
     QSize areasize;
 
@@ -296,6 +293,7 @@ void GraphView::computeLayout()
     m_scalemin = std::min(static_cast<qreal>(std::min(sx, sy) * (1 - m_scalestep)), 0.05); // If graph is very large...
 
     this->adjustSize(areasize.width(), areasize.height());
+    this->updateMinimap();
     this->viewport()->update();
 }
 
@@ -395,36 +393,60 @@ void GraphView::adjustSize(int vpw, int vph, const QPoint &cursorpos, bool fit)
         this->horizontalScrollBar()->setValue(scrollrange.width() / 2);
         this->verticalScrollBar()->setValue(scrollrange.height() / 2);
     }
+
+    m_minimap->move(vpw - m_minimap->width() - MINIMAP_MARGIN, vph - m_minimap->height() - MINIMAP_MARGIN);
+    this->updateMinimapRect();
 }
 
-void GraphView::precomputeArrow(const REDasm::Graphing::Edge &e)
+void GraphView::precomputeEdge(const REDasm::Graphing::Edge &e)
 {
-    const REDasm::Graphing::Polyline& path = m_graph->arrow(e);
-    QPolygon arrowhead;
+    int group = m_edges.group(QColor(QString::fromStdString(m_graph->color(e))));
+    QVector<QLine>& lines = m_edges.lines[group];
+    QVector<QPolygon>& arrows = m_edges.arrows[group];
 
-    for(int i = 0; i < path.size(); i++)
+    const REDasm::Graphing::Polyline& path = m_graph->routes(e);
+    EdgeRange range = { e, QRect(), group, lines.size(), 0, arrows.size() };
+    QPolygon points;
+
+    for(size_t i = 0; !path.empty() && (i < path.size() - 1); i++)
     {
         const REDasm::Graphing::Point& p1 = path[i];
-        arrowhead << QPoint(p1.x, p1.y);
+        const REDasm::Graphing::Point& p2 = path[i + 1];
+        lines.push_back(QLine(p1.x, p1.y, p2.x, p2.y));
+        points << QPoint(p1.x, p1.y) << QPoint(p2.x, p2.y);
     }
 
-    m_arrows[e] = arrowhead;
+    const REDasm::Graphing::Polyline& arrow = m_graph->arrow(e);
+    QPolygon arrowhead;
+
+    for(size_t i = 0; i < arrow.size(); i++)
+        arrowhead << QPoint(arrow[i].x, arrow[i].y);
+
+    arrows.push_back(arrowhead);
+
+    range.linecount = lines.size() - range.line;
+    range.rect = points.united(arrowhead).boundingRect().adjusted(-2, -2, 2, 2);
+    m_scenerect |= range.rect;
+    m_edgeranges.push_back(range);
 }
 
-void GraphView::precomputeLine(const REDasm::Graphing::Edge &e)
+void GraphView::updateHighlightedEdges()
 {
-    const REDasm::Graphing::Polyline& path = m_graph->routes(e);
+    // Same colours and pens, only the selected block's edges
+    m_highlightededges = m_edges;
+    m_highlightededges.clearGeometry();
 
-    QVector<QLine> lines;
+    if(!m_selecteditem)
+        return;
 
-    for(size_t i = 0; !path.empty() && (i < path.size() - 1); i++)
+    for(const EdgeRange& range : m_edgeranges)
     {
-        const REDasm::Graphing::Point& p1 = path[i];
-        const REDasm::Graphing::Point& p2 = path[i + 1];
-        lines.push_back(QLine(p1.x, p1.y, p2.x, p2.y));
-    }
+        if((range.edge.source != m_selecteditem->node()) && (range.edge.target != m_selecteditem->node()))
+            continue;
 
-    m_lines[e] = lines;
+        m_highlightededges.lines[range.group] += m_edges.lines[range.group].mid(range.line, range.linecount);
+        m_highlightededges.arrows[range.group].push_back(m_edges.arrows[range.group][range.arrow]);
+    }
 }
 
 bool GraphView::updateSelectedItem(QMouseEvent *e)
@@ -441,5 +463,171 @@ bool GraphView::updateSelectedItem(QMouseEvent *e)
     if(m_selecteditem)
         m_selecteditem->itemSelectionChanged(false);
 
+    this->invalidateSelection(olditem);
     return olditem != m_selecteditem;
 }
+
+QPoint GraphView::renderTranslation() const
+{
+    return { m_renderoffset.x() - this->horizontalScrollBar()->value(),
+             m_renderoffset.y() - this->verticalScrollBar()->value() };
+}
+
+QRect GraphView::itemSceneRect(const GraphViewItem *item) const { return item->rect().adjusted(-ITEM_SCENE_MARGIN, -ITEM_SCENE_MARGIN, ITEM_SCENE_MARGIN, ITEM_SCENE_MARGIN); }
+
+const QPicture &GraphView::itemPicture(GraphViewItem *item)
+{
+    auto it = m_pictures.find(item);
+
+    if(it != m_pictures.end())
+        return it.value();
+
+    QPicture picture;
+    QPainter painter(&picture);
+    painter.setPen(this->viewport()->palette().color(this->viewport()->foregroundRole())); // Same initial pen as the viewport
+    item->render(&painter, GraphViewItem::None);
+    painter.end();
+
+    return m_pictures.insert(item, picture).value();
+}
+
+GraphViewSnapshot GraphView::sceneSnapshot()
+{
+    GraphViewSnapshot snapshot = this->snapshot(m_scenerect);
+    snapshot.edgestyle = GraphViewEdges::Solid; // Exports don't depend on the current selection
+    return snapshot;
+}
+
+const QRect &GraphView::sceneRect() const { return m_scenerect; }
+
+GraphViewSnapshot GraphView::snapshot(const QRect &graphrect)
+{
+    GraphViewSnapshot snapshot;
+    snapshot.background = this->palette().color(QPalette::Base);
+    snapshot.dpi = this->viewport()->logicalDpiX();
+
+    snapshot.edgestyle = m_selecteditem ? GraphViewEdges::Dashed : GraphViewEdges::Solid;
+
+    snapshot.edges = m_edges; // Same colours and pens, only the edges crossing 'graphrect'
+    snapshot.edges.clearGeometry();
+    bool hasedges = false;
+
+    for(const EdgeRange& range : m_edgeranges)
+    {
+        if(!graphrect.intersects(range.rect))
+            continue;
+
+        snapshot.edges.lines[range.group] += m_edges.lines[range.group].mid(range.line, range.linecount);
+        snapshot.edges.arrows[range.group].push_back(m_edges.arrows[range.group][range.arrow]);
+        hasedges = true;
+    }
+
+    if(!hasedges)
+        snapshot.edges.clear();
+
+    for(GraphViewItem* item : m_items)
+    {
+        QRect r = this->itemSceneRect(item);
+
+        if(!graphrect.intersects(r))
+            continue;
+
+        snapshot.blocks.push_back({ r, this->itemPicture(item) });
+    }
+
+    return snapshot;
+}
+
+void GraphView::renderTiles(QPainter *painter, const QPoint &translation, const QRect &exposedrect)
+{
+    QRect scenerect(m_scenerect.topLeft() * m_scalefactor, m_scenerect.size() * m_scalefactor);
+    QRect visiblerect = exposedrect.translated(-translation) & scenerect;
+
+    if(visiblerect.isEmpty())
+        return;
+
+    int zoom = GraphViewTileCache::zoomKey(m_scalefactor);
+
+    for(int y = tileIndex(visiblerect.top()); y <= tileIndex(visiblerect.bottom()); y++)
+    {
+        for(int x = tileIndex(visiblerect.left()); x <= tileIndex(visiblerect.right()); x++)
+        {
+            GraphViewTileKey key = { zoom, x, y };
+            QRect tilerect = GraphViewTileCache::tileRect(key);
+            const QImage* tile = m_tiles->tile(key);
+
+            if(tile)
+            {
+                painter->drawImage(tilerect.topLeft() + translation, *tile);
+                continue;
+            }
+
+            if(m_tiles->isPending(key)) // The background stays until the worker delivers it
+                continue;
+
+            QRect graphrect(static_cast<int>(std::floor(tilerect.x() / m_scalefactor)),
+                            static_cast<int>(std::floor(tilerect.y() / m_scalefactor)),
+                            static_cast<int>(std::ceil(tilerect.width() / m_scalefactor)) + 1,
+                            static_cast<int>(std::ceil(tilerect.height() / m_scalefactor)) + 1);
+
+            GraphViewSnapshot snapshot = this->snapshot(graphrect);
+
+            if(snapshot.empty())
+                continue;
+
+            m_tiles->request(key, snapshot, m_scalefactor);
+        }
+    }
+}
+
+void GraphView::invalidateItem(GraphViewItem *item)
+{
+    QRect r = this->itemSceneRect(item);
+    auto it = m_pictures.find(item);
+
+    if(it != m_pictures.end()) // Item may have shrunk, clear what it painted before
+    {
+        r |= it->boundingRect();
+        m_pictures.erase(it);
+    }
+
+    m_tiles->invalidate(r);
+}
+
+void GraphView::invalidateSelection(GraphViewItem *olditem)
+{
+    if(olditem == m_selecteditem)
+        return;
+
+    this->updateHighlightedEdges();
+
+    if(olditem) // It was rendered live, cached copy may be outdated
+        this->invalidateItem(olditem);
+
+    if(!olditem || !m_selecteditem) // Edges are dashed only when a block is selected
+        m_tiles->clear();
+}
+
+void GraphView::updateMinimap()
+{
+    // Low LOD copy of the whole scene: blocks are plain boxes
+    GraphViewSnapshot snapshot;
+    snapshot.background = this->palette().color(QPalette::Base);
+    snapshot.blockcolor = this->palette().color(QPalette::WindowText);
+    snapshot.dpi = this->viewport()->logicalDpiX();
+    snapshot.edges = m_edges;
+
+    for(GraphViewItem* item : m_items)
+        snapshot.blocks.push_back({ item->rect(), QPicture() });
+
+    m_minimap->setSnapshot(snapshot, m_scenerect);
+    m_minimap->move(this->viewport()->width() - m_minimap->width() - MINIMAP_MARGIN, this->viewport()->height() - m_minimap->height() - MINIMAP_MARGIN);
+    this->updateMinimapRect();
+}
+
+void GraphView::updateMinimapRect()
+{
+    QPoint translation = this->renderTranslation();
+    QSizeF vpsize = this->viewport()->size();
+    m_minimap->setViewRect(QRectF(-translation.x() / m_scalefactor, -translation.y() / m_scalefactor, vpsize.width() / m_scalefactor, vpsize.height() / m_scalefactor));
+}
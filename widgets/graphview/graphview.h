@@ -11,6 +11,8 @@
 #include <redasm/disassembler/disassemblerapi.h>
 #include <redasm/graph/graph.h>
 #include "../../../themeprovider.h"
+#include "graphviewtilecache.h"
+#include "graphviewminimap.h"
 #include "graphviewitem.h"
 
 class GraphView : public QAbstractScrollArea
@@ -25,12 +27,16 @@ class GraphView : public QAbstractScrollArea
         void setFocusOnSelection(bool b);
         GraphViewItem* selectedItem() const;
         REDasm::Graphing::Graph* graph() const;
+        GraphViewSnapshot sceneSnapshot();
+        const QRect& sceneRect() const;
 
     public slots:
         void focusSelectedBlock();
+        void centerOn(const QPointF& scenepos);
 
     protected:
         void focusBlock(const GraphViewItem* item, bool force = false);
+        GraphViewSnapshot snapshot(const QRect& graphrect);
 
     protected:
         void mouseDoubleClickEvent(QMouseEvent* e) override;
@@ -46,11 +52,19 @@ class GraphView : public QAbstractScrollArea
 
     private:
         GraphViewItem* itemFromMouseEvent(QMouseEvent *e) const;
+        QPoint renderTranslation() const;
+        QRect itemSceneRect(const GraphViewItem* item) const;
+        const QPicture& itemPicture(GraphViewItem* item);
+        void renderTiles(QPainter* painter, const QPoint& translation, const QRect& exposedrect);
+        void invalidateItem(GraphViewItem* item);
+        void invalidateSelection(GraphViewItem* olditem);
+        void updateMinimap();
+        void updateMinimapRect();
         void zoomOut(const QPoint& cursorpos);
         void zoomIn(const QPoint& cursorpos);
         void adjustSize(int vpw, int vph, const QPoint& cursorpos = QPoint(), bool fit = false);
-        void precomputeArrow(const REDasm::Graphing::Edge& e);
-        void precomputeLine(const REDasm::Graphing::Edge& e);
+        void precomputeEdge(const REDasm::Graphing::Edge& e);
+        void updateHighlightedEdges();
         bool updateSelectedItem(QMouseEvent* e);
 
     protected:
@@ -60,11 +74,18 @@ class GraphView : public QAbstractScrollArea
     signals:
         void selectedItemChanged();
 
+    private:
+        struct EdgeRange { REDasm::Graphing::Edge edge; QRect rect; int group, line, linecount, arrow; };
+
     private:
         GraphViewItem* m_selecteditem;
         REDasm::Graphing::Graph* m_graph;
-        std::unordered_map< REDasm::Graphing::Edge, QVector<QLine> > m_lines;
-        std::unordered_map<REDasm::Graphing::Edge, QPolygon> m_arrows;
+        GraphViewEdges m_edges, m_highlightededges;
+        QVector<EdgeRange> m_edgeranges;
+        QHash<GraphViewItem*, QPicture> m_pictures;
+        GraphViewTileCache* m_tiles;
+        GraphViewMinimap* m_minimap;
+        QRect m_scenerect;
         QPoint m_renderoffset, m_scrollbase;
         QSize m_rendersize;
         qreal m_scalefactor, m_scalestep, m_prevscalefactor;
@@ -0,0 +1,113 @@
+#include "graphviewminimap.h"
+#include <QtConcurrent>
+#include <QFutureWatcher>
+#include <QMouseEvent>
+#include <QPainter>
+
+#define MINIMAP_BORDER 1
+
+GraphViewMinimap::GraphViewMinimap(QWidget *parent) : QWidget(parent), m_scale(1.0), m_generation(0)
+{
+    this->setCursor(Qt::PointingHandCursor);
+    this->hide();
+}
+
+void GraphViewMinimap::setSnapshot(const GraphViewSnapshot &snapshot, const QRect &scenerect)
+{
+    this->clear();
+
+    if(scenerect.isEmpty())
+        return;
+
+    m_scenerect = scenerect;
+    m_scale = std::min(GRAPHVIEW_MINIMAP_SIZE / static_cast<qreal>(scenerect.width()), GRAPHVIEW_MINIMAP_SIZE / static_cast<qreal>(scenerect.height()));
+
+    QRect rect(QPointF(scenerect.topLeft() * m_scale).toPoint(), QSizeF(scenerect.size() * m_scale).toSize().expandedTo(QSize(1, 1)));
+    this->resize(rect.size() + QSize(MINIMAP_BORDER * 2, MINIMAP_BORDER * 2));
+
+    quint64 generation = m_generation;
+    qreal scale = m_scale;
+    auto* watcher = new QFutureWatcher<QImage>(this);
+
+    connect(watcher, &QFutureWatcher<QImage>::finished, this, [=]() {
+        if(generation == m_generation) // Discard thumbnails of older graphs
+        {
+            m_thumbnail = watcher->result();
+            this->update();
+        }
+
+        watcher->deleteLater();
+    });
+
+    watcher->setFuture(QtConcurrent::run([=]() -> QImage { return snapshot.renderImage(rect, scale); }));
+}
+
+void GraphViewMinimap::setViewRect(const QRectF &viewrect)
+{
+    QRect oldrect = this->mapFromScene(m_viewrect);
+    m_viewrect = viewrect;
+
+    if(m_scenerect.isEmpty())
+        return;
+
+    bool visible = !viewrect.contains(m_scenerect); // Nothing to navigate if the whole graph is in view
+    this->setVisible(visible);
+
+    if(visible)
+        this->update(oldrect.united(this->mapFromScene(m_viewrect)).adjusted(-1, -1, 1, 1));
+}
+
+void GraphViewMinimap::clear()
+{
+    m_generation++;
+    m_thumbnail = QImage();
+    m_scenerect = QRect();
+    this->hide();
+}
+
+void GraphViewMinimap::mousePressEvent(QMouseEvent *e)
+{
+    if(e->button() == Qt::LeftButton)
+        emit centerRequested(this->mapToScene(e->pos()));
+
+    e->accept();
+}
+
+void GraphViewMinimap::mouseMoveEvent(QMouseEvent *e)
+{
+    if(e->buttons() & Qt::LeftButton)
+        emit centerRequested(this->mapToScene(e->pos()));
+
+    e->accept();
+}
+
+void GraphViewMinimap::paintEvent(QPaintEvent *e)
+{
+    QPainter painter(this);
+    painter.setClipRect(e->rect());
+    painter.fillRect(this->rect(), this->palette().color(QPalette::Base));
+
+    if(!m_thumbnail.isNull())
+        painter.drawImage(MINIMAP_BORDER, MINIMAP_BORDER, m_thumbnail);
+
+    QColor highlight = this->palette().color(QPalette::Highlight);
+    painter.setPen(highlight);
+    highlight.setAlpha(48);
+    painter.setBrush(highlight);
+    painter.drawRect(this->mapFromScene(m_viewrect).intersected(this->rect().adjusted(0, 0, -1, -1)));
+
+    painter.setPen(this->palette().color(QPalette::WindowText));
+    painter.setBrush(Qt::NoBrush);
+    painter.drawRect(this->rect().adjusted(0, 0, -1, -1));
+}
+
+QRect GraphViewMinimap::mapFromScene(const QRectF &r) const
+{
+    return QRectF((r.x() - m_scenerect.x()) * m_scale + MINIMAP_BORDER, (r.y() - m_scenerect.y()) * m_scale + MINIMAP_BORDER,
+                  r.width() * m_scale, r.height() * m_scale).toAlignedRect();
+}
+
+QPointF GraphViewMinimap::mapToScene(const QPoint &p) const
+{
+    return QPointF(((p.x() - MINIMAP_BORDER) / m_scale) + m_scenerect.x(), ((p.y() - MINIMAP_BORDER) / m_scale) + m_scenerect.y());
+}
@@ -0,0 +1,42 @@
+#ifndef GRAPHVIEWMINIMAP_H
+#define GRAPHVIEWMINIMAP_H
+
+#include <QWidget>
+#include <QImage>
+#include "graphviewsnapshot.h"
+
+#define GRAPHVIEW_MINIMAP_SIZE 200 // px
+
+// Overview of the whole graph: the thumbnail is rendered once per layout on a worker thread,
+// scrolling only repaints the area covered by the old and new viewport rectangles
+class GraphViewMinimap : public QWidget
+{
+    Q_OBJECT
+
+    public:
+        explicit GraphViewMinimap(QWidget *parent = nullptr);
+        void setSnapshot(const GraphViewSnapshot& snapshot, const QRect& scenerect);
+        void setViewRect(const QRectF& viewrect);
+        void clear();
+
+    protected:
+        void mousePressEvent(QMouseEvent* e) override;
+        void mouseMoveEvent(QMouseEvent* e) override;
+        void paintEvent(QPaintEvent* e) override;
+
+    private:
+        QRect mapFromScene(const QRectF& r) const;
+        QPointF mapToScene(const QPoint& p) const;
+
+    signals:
+        void centerRequested(const QPointF& scenepos);
+
+    private:
+        QImage m_thumbnail;
+        QRect m_scenerect;
+        QRectF m_viewrect;
+        qreal m_scale;
+        quint64 m_generation;
+};
+
+#endif // GRAPHVIEWMINIMAP_H
@@ -0,0 +1,92 @@
+#include "graphviewsnapshot.h"
+#include <QPainter>
+#include <cmath>
+
+#define INCHES_PER_METER 39.37
+
+void GraphViewEdges::clear()
+{
+    colors.clear();
+    pens.clear();
+    this->clearGeometry();
+}
+
+void GraphViewEdges::clearGeometry()
+{
+    lines = QVector< QVector<QLine> >(colors.size());
+    arrows = QVector< QVector<QPolygon> >(colors.size());
+}
+
+int GraphViewEdges::group(const QColor &color)
+{
+    int idx = colors.indexOf(color);
+
+    if(idx != -1)
+        return idx;
+
+    QPen pen(color);
+    pen.setCosmetic(true);
+
+    colors.push_back(color);
+    lines.push_back(QVector<QLine>());
+    arrows.push_back(QVector<QPolygon>());
+
+    pens.push_back(pen);                 // Solid
+    pen.setStyle(Qt::DashLine);
+    pens.push_back(pen);                 // Dashed
+    pen.setStyle(Qt::SolidLine);
+    pen.setWidthF(2.0);
+    pens.push_back(pen);                 // Highlighted
+
+    return colors.size() - 1;
+}
+
+void GraphViewEdges::render(QPainter *painter, int style) const
+{
+    painter->save();
+
+    for(int i = 0; i < colors.size(); i++)
+    {
+        painter->setPen(pens[(i * StyleCount) + style]);
+        painter->setBrush(colors[i]);
+        painter->drawLines(lines[i]);
+
+        if(style == Dashed) // Arrows are always solid
+            painter->setPen(pens[(i * StyleCount) + Solid]);
+
+        for(const QPolygon& arrow : arrows[i])
+            painter->drawConvexPolygon(arrow);
+    }
+
+    painter->restore();
+}
+
+bool GraphViewSnapshot::empty() const { return blocks.empty() && edges.colors.empty(); }
+
+void GraphViewSnapshot::render(QPainter *painter) const
+{
+    edges.render(painter, edgestyle);
+
+    for(const Block& block : blocks)
+    {
+        if(block.picture.isNull())
+            painter->fillRect(block.rect, blockcolor);
+        else
+            painter->drawPicture(0, 0, block.picture);
+    }
+}
+
+QImage GraphViewSnapshot::renderImage(const QRect &rect, qreal scale) const
+{
+    // 'rect' is in scaled coordinates
+    QImage image(rect.size(), QImage::Format_ARGB32_Premultiplied);
+    image.setDotsPerMeterX(static_cast<int>(std::round(dpi * INCHES_PER_METER))); // Keep font metrics in sync with the screen
+    image.setDotsPerMeterY(static_cast<int>(std::round(dpi * INCHES_PER_METER)));
+    image.fill(background);
+
+    QPainter painter(&image);
+    painter.translate(-rect.topLeft());
+    painter.scale(scale, scale);
+    this->render(&painter);
+    return image;
+}
@@ -0,0 +1,45 @@
+#ifndef GRAPHVIEWSNAPSHOT_H
+#define GRAPHVIEWSNAPSHOT_H
+
+#include <QPicture>
+#include <QPolygon>
+#include <QVector>
+#include <QColor>
+#include <QImage>
+#include <QRect>
+#include <QLine>
+#include <QPen>
+
+// Edge geometry grouped by colour: every group is drawn with a couple of calls
+struct GraphViewEdges
+{
+    enum { Solid = 0, Dashed, Highlighted, StyleCount };
+
+    QVector<QColor> colors;
+    QVector< QVector<QLine> > lines;
+    QVector< QVector<QPolygon> > arrows;
+    QVector<QPen> pens; // colors.size() * StyleCount, cosmetic pens don't depend on zoom
+
+    void clear();
+    void clearGeometry();
+    int group(const QColor& color);
+    void render(QPainter* painter, int style) const;
+};
+
+// Immutable copy of (a part of) a graph scene, it can be rendered from worker threads
+struct GraphViewSnapshot
+{
+    struct Block { QRect rect; QPicture picture; }; // Blocks without a picture are drawn as plain boxes (low LOD)
+
+    GraphViewEdges edges;
+    QVector<Block> blocks;
+    QColor background, blockcolor;
+    int edgestyle, dpi;
+
+    GraphViewSnapshot(): edgestyle(GraphViewEdges::Solid), dpi(96) { }
+    bool empty() const;
+    void render(QPainter* painter) const;
+    QImage renderImage(const QRect& rect, qreal scale) const;
+};
+
+#endif // GRAPHVIEWSNAPSHOT_H
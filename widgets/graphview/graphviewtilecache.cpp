@@ -0,0 +1,82 @@
+#include "graphviewtilecache.h"
+#include <QtConcurrent>
+#include <QFutureWatcher>
+
+#define ZOOM_PRECISION 1000.0
+
+GraphViewTileCache::GraphViewTileCache(QObject *parent) : QObject(parent), m_lastrequest(0), m_generation(std::make_shared< std::atomic<quint64> >(0)) { m_tiles.setMaxCost(GRAPHVIEW_TILE_BUDGET); }
+void GraphViewTileCache::setMemoryBudget(int kb) { m_tiles.setMaxCost(kb); }
+const QImage *GraphViewTileCache::tile(const GraphViewTileKey &key) const { return m_tiles.object(key); }
+bool GraphViewTileCache::isPending(const GraphViewTileKey &key) const { return m_pending.contains(key); }
+
+void GraphViewTileCache::request(const GraphViewTileKey &key, const GraphViewSnapshot &snapshot, qreal scale)
+{
+    if(m_pending.contains(key) || m_tiles.contains(key))
+        return;
+
+    quint64 generation = m_generation->load(), requestid = ++m_lastrequest;
+    std::shared_ptr< std::atomic<quint64> > currentgeneration = m_generation;
+    QRect rect = GraphViewTileCache::tileRect(key);
+    m_pending[key] = requestid;
+
+    auto* watcher = new QFutureWatcher<QImage>(this);
+
+    connect(watcher, &QFutureWatcher<QImage>::finished, this, [=]() {
+        QImage image = watcher->result();
+        watcher->deleteLater();
+
+        auto it = m_pending.find(key);
+
+        if((it == m_pending.end()) || (it.value() != requestid)) // Invalidated or superseded by a newer request
+            return;
+
+        m_pending.erase(it);
+
+        if(image.isNull() || (generation != m_generation->load()))
+            return;
+
+        m_tiles.insert(key, new QImage(image), (image.bytesPerLine() * image.height()) / 1024);
+        emit tileReady(key);
+    });
+
+    watcher->setFuture(QtConcurrent::run([=]() -> QImage {
+        if(currentgeneration->load() != generation) // Invalidated while waiting in the pool
+            return QImage();
+
+        return snapshot.renderImage(rect, scale);
+    }));
+}
+
+void GraphViewTileCache::invalidate(const QRect &graphrect)
+{
+    for(const GraphViewTileKey& key : m_tiles.keys())
+    {
+        if(GraphViewTileCache::tileGraphRect(key).intersects(graphrect))
+            m_tiles.remove(key);
+    }
+
+    for(auto it = m_pending.begin(); it != m_pending.end(); )
+    {
+        if(GraphViewTileCache::tileGraphRect(it.key()).intersects(graphrect)) // Other in-flight tiles are still valid
+            it = m_pending.erase(it);
+        else
+            it++;
+    }
+}
+
+void GraphViewTileCache::clear()
+{
+    m_tiles.clear();
+    m_pending.clear();
+    m_generation->fetch_add(1);
+}
+
+int GraphViewTileCache::zoomKey(qreal scale) { return qRound(scale * ZOOM_PRECISION); }
+QRect GraphViewTileCache::tileRect(const GraphViewTileKey &key) { return QRect(key.x * GRAPHVIEW_TILE_SIZE, key.y * GRAPHVIEW_TILE_SIZE, GRAPHVIEW_TILE_SIZE, GRAPHVIEW_TILE_SIZE); }
+
+QRectF GraphViewTileCache::tileGraphRect(const GraphViewTileKey &key)
+{
+    qreal scale = key.zoom / ZOOM_PRECISION;
+    QRectF r = GraphViewTileCache::tileRect(key);
+    return QRectF(r.x() / scale, r.y() / scale, r.width() / scale, r.height() / scale);
+}
@@ -0,0 +1,54 @@
+#ifndef GRAPHVIEWTILECACHE_H
+#define GRAPHVIEWTILECACHE_H
+
+#include <QObject>
+#include <QCache>
+#include <QHash>
+#include <QPair>
+#include <atomic>
+#include <memory>
+#include "graphviewsnapshot.h"
+
+#define GRAPHVIEW_TILE_SIZE   256
+#define GRAPHVIEW_TILE_BUDGET (64 * 1024) // 64MB, in KB
+
+struct GraphViewTileKey
+{
+    int zoom, x, y;
+
+    bool operator ==(const GraphViewTileKey& rhs) const { return (zoom == rhs.zoom) && (x == rhs.x) && (y == rhs.y); }
+};
+
+inline uint qHash(const GraphViewTileKey& key, uint seed = 0) { return qHash(key.zoom, seed) ^ qHash(qMakePair(key.x, key.y), seed); } // Tiles can be negative
+
+class GraphViewTileCache : public QObject
+{
+    Q_OBJECT
+
+    public:
+        explicit GraphViewTileCache(QObject *parent = nullptr);
+        void setMemoryBudget(int kb);
+        const QImage* tile(const GraphViewTileKey& key) const;
+        bool isPending(const GraphViewTileKey& key) const;
+        void request(const GraphViewTileKey& key, const GraphViewSnapshot& snapshot, qreal scale);
+        void invalidate(const QRect& graphrect);
+        void clear();
+
+    public:
+        static int zoomKey(qreal scale);
+        static QRect tileRect(const GraphViewTileKey& key);
+
+    private:
+        static QRectF tileGraphRect(const GraphViewTileKey& key);
+
+    signals:
+        void tileReady(const GraphViewTileKey& key);
+
+    private:
+        QCache<GraphViewTileKey, QImage> m_tiles;
+        QHash<GraphViewTileKey, quint64> m_pending; // Request id of the in-flight tile
+        quint64 m_lastrequest;
+        std::shared_ptr< std::atomic<quint64> > m_generation;
+};
+
+#endif // GRAPHVIEWTILECACHE_H
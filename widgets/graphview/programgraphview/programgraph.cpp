@@ -0,0 +1,96 @@
+#include "programgraph.h"
+#include "../../../models/disassemblermodel.h"
+#include <redasm/disassembler/listing/listingdocument.h>
+#include <redasm/support/demangler.h>
+#include <QStringList>
+#include <algorithm>
+
+int ProgramGraph::nodesCount() const { return addresses.size(); }
+int ProgramGraph::edgesCount() const { return edgetargets.size(); }
+
+int ProgramGraph::indexOf(address_t address) const
+{
+    auto it = std::lower_bound(addresses.begin(), addresses.end(), address);
+
+    if((it == addresses.end()) || (*it != address))
+        return -1;
+
+    return static_cast<int>(std::distance(addresses.begin(), it));
+}
+
+ProgramGraph ProgramGraph::build(const REDasm::DisassemblerPtr &disassembler, const CallGraph::Graph* callgraph)
+{
+    ProgramGraph graph;
+    QStringList segmentnames;
+    QVector<int> segments; // Segment of each function
+    graph.addresses = callgraph->functions;
+
+    {
+        auto lock = REDasm::s_lock_safe_ptr(disassembler->document());
+        QHash<const REDasm::Segment*, int> segmentindex;
+
+        for(address_t address : graph.addresses)
+        {
+            const REDasm::Segment* segment = lock->segment(address);
+            auto it = segmentindex.find(segment);
+
+            if(it == segmentindex.end())
+            {
+                it = segmentindex.insert(segment, segmentnames.size());
+                segmentnames.push_back(segment ? S_TO_QS(segment->name) : QString("???"));
+            }
+
+            segments.push_back(it.value());
+        }
+    }
+
+    QVector<int> segmentsize(segmentnames.size(), 0), segmentfill(segmentnames.size(), 0);
+    QHash<quint64, int> clusters;
+
+    for(int segment : segments)
+        segmentsize[segment]++;
+
+    for(int i = 0; i < graph.addresses.size(); i++)
+    {
+        // Big segments (a single .text, usually) are split in address ranges: they can be collapsed too
+        int segment = segments[i];
+        quint64 part = static_cast<quint64>(segmentfill[segment]++ / PROGRAMGRAPH_CLUSTER_SIZE);
+        auto it = clusters.find((static_cast<quint64>(segment) << 32) | part);
+
+        if(it == clusters.end())
+        {
+            it = clusters.insert((static_cast<quint64>(segment) << 32) | part, graph.clusternames.size());
+
+            if(segmentsize[segment] > PROGRAMGRAPH_CLUSTER_SIZE)
+                graph.clusternames.push_back(QString("%1:%2").arg(segmentnames[segment], S_TO_QS(REDasm::hex(graph.addresses[i]))));
+            else
+                graph.clusternames.push_back(segmentnames[segment]);
+        }
+
+        const QString& name = callgraph->names[i];
+        graph.names.push_back(name.isEmpty() ? S_TO_QS(REDasm::hex(graph.addresses[i])) : S_TO_QS(REDasm::Demangler::demangled(name.toStdString())));
+        graph.clusters.push_back(it.value());
+    }
+
+    graph.edgeoffsets.reserve(graph.nodesCount() + 1);
+    graph.edgeoffsets.push_back(0);
+
+    for(int i = 0; i < graph.nodesCount(); i++) // Calls of a function merged by callee
+    {
+        QVector<int> callees;
+        const CallGraph::Call* calls = callgraph->callsBegin(i);
+
+        for(int j = 0; j < callgraph->callsCount(i); j++)
+        {
+            if((calls[j].callee != -1) && (calls[j].callee != i))
+                callees.push_back(calls[j].callee);
+        }
+
+        std::sort(callees.begin(), callees.end());
+        callees.erase(std::unique(callees.begin(), callees.end()), callees.end());
+        graph.edgetargets += callees;
+        graph.edgeoffsets.push_back(graph.edgetargets.size());
+    }
+
+    return graph;
+}
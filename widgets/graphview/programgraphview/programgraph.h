@@ -0,0 +1,29 @@
+#ifndef PROGRAMGRAPH_H
+#define PROGRAMGRAPH_H
+
+#include <QVector>
+#include <QString>
+#include <redasm/disassembler/disassemblerapi.h>
+#include "../../../models/callgraph.h"
+
+#define PROGRAMGRAPH_CLUSTER_SIZE 1000 // Functions
+
+// Whole program call graph stored in flat arrays (functions are sorted by address):
+// function 'i' calls edgetargets[edgeoffsets[i] ... edgeoffsets[i + 1] - 1].
+// Built from a CallGraph snapshot: call sites are merged by callee and functions grouped in clusters.
+struct ProgramGraph
+{
+    QVector<address_t> addresses;
+    QVector<QString> names;
+    QVector<int> clusters;          // Cluster of each function: its segment or a part of it
+    QVector<QString> clusternames;
+    QVector<int> edgeoffsets, edgetargets;
+
+    int nodesCount() const;
+    int edgesCount() const;
+    int indexOf(address_t address) const;
+
+    static ProgramGraph build(const REDasm::DisassemblerPtr& disassembler, const CallGraph::Graph* callgraph);
+};
+
+#endif // PROGRAMGRAPH_H
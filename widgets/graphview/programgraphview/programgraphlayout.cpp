@@ -0,0 +1,251 @@
+#include "programgraphlayout.h"
+#include "../../../workchunks.h"
+#include <QtConcurrent>
+#include <QVarLengthArray>
+#include <QElapsedTimer>
+#include <QRectF>
+#include <cmath>
+
+#define LAYOUT_CHUNK_SIZE        1024
+#define LAYOUT_MAX_ITERATIONS    600
+#define LAYOUT_MIN_TEMPERATURE   (PROGRAMGRAPH_NODE_DISTANCE * 0.02)
+#define LAYOUT_COOLING           0.97
+#define LAYOUT_GRAVITY           0.5
+#define LAYOUT_THETA             1.0  // Barnes-Hut accuracy: bigger is faster and coarser
+#define LAYOUT_PUBLISH_INTERVAL  50   // ms
+#define QUADTREE_MAX_DEPTH       32
+
+namespace {
+
+// Flat quadtree, rebuilt at every iteration
+class QuadTree
+{
+    private:
+        struct Cell { qreal x, y, size, mx, my, mass; int children, body, count; };
+
+    public:
+        void build(const QVector<QPointF>& positions, const QVector<qreal>& masses)
+        {
+            QRectF r;
+
+            for(const QPointF& p : positions)
+                r |= QRectF(p, QSizeF(1, 1));
+
+            m_positions = &positions;
+            m_masses = &masses;
+            m_cells.clear();
+            m_cells.push_back({ r.x(), r.y(), std::max(r.width(), r.height()), 0, 0, 0, -1, -1, 0 });
+
+            for(int i = 0; i < positions.size(); i++)
+                this->insert(i);
+
+            for(Cell& c : m_cells)
+            {
+                if(c.mass <= 0)
+                    continue;
+
+                c.mx /= c.mass; // Center of mass
+                c.my /= c.mass;
+            }
+        }
+
+        QPointF repulsion(int body, qreal k2) const
+        {
+            const QPointF& p = m_positions->at(body);
+            QVarLengthArray<int, QUADTREE_MAX_DEPTH * 4> stack;
+            QPointF f;
+
+            stack.append(0);
+
+            while(!stack.isEmpty())
+            {
+                const Cell& c = m_cells[stack.last()];
+                stack.removeLast();
+
+                if((c.mass <= 0) || ((c.children == -1) && (c.body == body) && (c.count == 1)))
+                    continue;
+
+                qreal dx = p.x() - c.mx, dy = p.y() - c.my;
+                qreal d2 = (dx * dx) + (dy * dy);
+
+                if((c.children != -1) && ((c.size * c.size) >= (LAYOUT_THETA * LAYOUT_THETA * d2)))
+                {
+                    for(int i = 0; i < 4; i++)
+                        stack.append(c.children + i);
+
+                    continue;
+                }
+
+                if(d2 < 1.0) // Overlapping: push it away in a stable direction
+                {
+                    dx = (body & 1) ? 1.0 : -1.0;
+                    dy = (body & 2) ? 1.0 : -1.0;
+                    d2 = 2.0;
+                }
+
+                qreal s = (k2 * c.mass) / d2;
+                f += QPointF(dx * s, dy * s);
+            }
+
+            return f;
+        }
+
+    private:
+        int quadrant(const Cell& c, const QPointF& p) const
+        {
+            qreal half = c.size / 2;
+            return ((p.x() >= c.x + half) ? 1 : 0) | ((p.y() >= c.y + half) ? 2 : 0);
+        }
+
+        void accumulate(int cell, int body)
+        {
+            const QPointF& p = m_positions->at(body);
+            qreal m = m_masses->at(body);
+            Cell& c = m_cells[cell];
+
+            if(!c.count)
+                c.body = body;
+
+            c.mx += p.x() * m;
+            c.my += p.y() * m;
+            c.mass += m;
+            c.count++;
+        }
+
+        void subdivide(int cell)
+        {
+            Cell c = m_cells[cell]; // push_back() may reallocate
+            qreal half = c.size / 2;
+
+            m_cells[cell].children = m_cells.size();
+            m_cells.push_back({ c.x,        c.y,        half, 0, 0, 0, -1, -1, 0 });
+            m_cells.push_back({ c.x + half, c.y,        half, 0, 0, 0, -1, -1, 0 });
+            m_cells.push_back({ c.x,        c.y + half, half, 0, 0, 0, -1, -1, 0 });
+            m_cells.push_back({ c.x + half, c.y + half, half, 0, 0, 0, -1, -1, 0 });
+        }
+
+        void insert(int body)
+        {
+            const QPointF& p = m_positions->at(body);
+            int cell = 0;
+
+            for(int depth = 0; ; depth++)
+            {
+                if(m_cells[cell].children == -1)
+                {
+                    if(!m_cells[cell].count || (depth >= QUADTREE_MAX_DEPTH))
+                    {
+                        this->accumulate(cell, body);
+                        return;
+                    }
+
+                    // Occupied leaf: move its body one level down
+                    int oldbody = m_cells[cell].body;
+                    this->subdivide(cell);
+                    this->accumulate(m_cells[cell].children + this->quadrant(m_cells[cell], m_positions->at(oldbody)), oldbody);
+                    m_cells[cell].body = -1;
+                }
+
+                Cell& c = m_cells[cell];
+                qreal m = m_masses->at(body);
+                c.mx += p.x() * m;
+                c.my += p.y() * m;
+                c.mass += m;
+                c.count++;
+                cell = c.children + this->quadrant(c, p);
+            }
+        }
+
+    private:
+        const QVector<QPointF>* m_positions;
+        const QVector<qreal>* m_masses;
+        QVector<Cell> m_cells;
+};
+
+} // namespace
+
+ProgramGraphLayout::ProgramGraphLayout(QObject *parent) : QObject(parent), m_stop(false), m_dirty(false) { }
+ProgramGraphLayout::~ProgramGraphLayout() { this->stop(); }
+bool ProgramGraphLayout::isRunning() const { return m_future.isRunning(); }
+
+bool ProgramGraphLayout::takePositions(QVector<QPointF> &positions)
+{
+    if(!m_dirty.exchange(false))
+        return false;
+
+    QMutexLocker locker(&m_mutex);
+    positions = m_published;
+    return true;
+}
+
+void ProgramGraphLayout::start(const Input &input)
+{
+    this->stop();
+    m_stop = m_dirty = false; // Drop positions of the previous graph
+    m_future = QtConcurrent::run([=]() { this->execute(input); });
+}
+
+void ProgramGraphLayout::stop()
+{
+    m_stop = true;
+    m_future.waitForFinished();
+}
+
+void ProgramGraphLayout::execute(Input input)
+{
+    QVector<QPointF>& positions = input.positions;
+    QVector<QPointF> displacements(positions.size());
+    auto chunks = workChunks<int>(0, positions.size(), LAYOUT_CHUNK_SIZE);
+
+    qreal k = PROGRAMGRAPH_NODE_DISTANCE, temperature = input.temperature;
+    QElapsedTimer timer;
+    QuadTree tree;
+    timer.start();
+
+    for(int iteration = 0; !m_stop && (iteration < LAYOUT_MAX_ITERATIONS) && (temperature > LAYOUT_MIN_TEMPERATURE); iteration++)
+    {
+        tree.build(positions, input.masses);
+
+        // Positions are read only here, every chunk writes its own displacements
+        QtConcurrent::blockingMap(chunks, [&](const QPair<int, int>& chunk) {
+            for(int i = chunk.first; i < chunk.second; i++)
+            {
+                const QPointF& p = positions[i];
+                QPointF f = tree.repulsion(i, k * k);
+
+                for(int j = input.adjoffsets[i]; j < input.adjoffsets[i + 1]; j++)
+                {
+                    QPointF d = positions[input.adjacency[j]] - p;
+                    f += d * (std::hypot(d.x(), d.y()) / k);
+                }
+
+                displacements[i] = f - (p * LAYOUT_GRAVITY);
+            }
+        });
+
+        for(int i = 0; i < positions.size(); i++)
+        {
+            const QPointF& d = displacements[i];
+            qreal len = std::hypot(d.x(), d.y());
+            positions[i] += (len > temperature) ? (d * (temperature / len)) : d;
+        }
+
+        temperature *= LAYOUT_COOLING;
+
+        if(timer.elapsed() < LAYOUT_PUBLISH_INTERVAL)
+            continue;
+
+        this->publish(positions);
+        timer.restart();
+    }
+
+    if(!m_stop)
+        this->publish(positions);
+}
+
+void ProgramGraphLayout::publish(const QVector<QPointF> &positions)
+{
+    QMutexLocker locker(&m_mutex);
+    m_published = positions;
+    m_dirty = true;
+}
@@ -0,0 +1,47 @@
+#ifndef PROGRAMGRAPHLAYOUT_H
+#define PROGRAMGRAPHLAYOUT_H
+
+#include <QObject>
+#include <QFuture>
+#include <QVector>
+#include <QPointF>
+#include <QMutex>
+#include <atomic>
+
+#define PROGRAMGRAPH_NODE_DISTANCE 120.0 // Ideal edge length, in scene units
+
+// Force directed layout (Fruchterman-Reingold with Barnes-Hut repulsion),
+// it runs on the thread pool and publishes intermediate positions while refining.
+class ProgramGraphLayout : public QObject
+{
+    Q_OBJECT
+
+    public:
+        struct Input
+        {
+            QVector<QPointF> positions;
+            QVector<qreal> masses;
+            QVector<int> adjoffsets, adjacency; // Undirected adjacency (CSR)
+            qreal temperature;                  // Lower it when positions are already good
+        };
+
+    public:
+        explicit ProgramGraphLayout(QObject *parent = nullptr);
+        virtual ~ProgramGraphLayout();
+        bool isRunning() const;
+        bool takePositions(QVector<QPointF>& positions);
+        void start(const Input& input);
+        void stop();
+
+    private:
+        void execute(Input input);
+        void publish(const QVector<QPointF>& positions);
+
+    private:
+        QFuture<void> m_future;
+        std::atomic<bool> m_stop, m_dirty;
+        QVector<QPointF> m_published;
+        QMutex m_mutex;
+};
+
+#endif // PROGRAMGRAPHLAYOUT_H
@@ -0,0 +1,742 @@
+#include "programgraphview.h"
+#include "../../../themeprovider.h"
+#include <redasm/disassembler/listing/listingdocument.h>
+#include <QtConcurrent>
+#include <QFutureWatcher>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QtMath>
+#include <QMenu>
+#include <QSet>
+#include <algorithm>
+#include <cmath>
+
+#define COLLAPSE_THRESHOLD    2000 // Functions
+#define REFRESH_INTERVAL      33   // ms
+#define NODE_PADDING          4
+#define NODE_MAX_WIDTH        240
+#define LOD_MIN_TEXT_HEIGHT   5    // px
+#define DENSE_EDGES           5000
+#define SCALE_MIN             0.001
+#define SCALE_MAX             4.0
+#define ZOOM_STEP             1.15
+#define GRID_CELLS            64   // Per side, tiles look up the nodes and edges they cross
+
+static inline int tileIndex(int v) { return static_cast<int>(std::floor(v / static_cast<qreal>(GRAPHVIEW_TILE_SIZE))); }
+
+static QPointF spiral(int idx, qreal spacing) // Golden angle spiral, used for initial placements
+{
+    qreal a = idx * 2.39996323, r = spacing * std::sqrt(idx + 1.0);
+    return QPointF(r * std::cos(a), r * std::sin(a));
+}
+
+ProgramGraphView::ProgramGraphView(QWidget *parent) : QAbstractScrollArea(parent), m_disassembler(nullptr), m_scale(1.0), m_selectednode(-1), m_refreshtimer(0)
+{
+    m_building = m_requested = m_rebuild = m_scrollmode = false;
+    m_autofit = true;
+
+    QPalette palette = this->palette();
+    palette.setColor(QPalette::Base, THEME_VALUE("graph_bg"));
+
+    this->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    this->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    this->setAutoFillBackground(true);
+    this->setPalette(palette);
+
+    m_layout = new ProgramGraphLayout(this);
+    m_tiles = new GraphViewTileCache(this);
+
+    connect(m_tiles, &GraphViewTileCache::tileReady, this, [&](const GraphViewTileKey& key) {
+        if(key.zoom != GraphViewTileCache::zoomKey(m_scale))
+            return;
+
+        this->viewport()->update(GraphViewTileCache::tileRect(key).translated(this->translation()));
+    });
+}
+
+void ProgramGraphView::setDisassembler(const REDasm::DisassemblerPtr &disassembler)
+{
+    if(m_callgraph)
+        disconnect(m_callgraph.get(), &CallGraph::graphChanged, this, nullptr);
+
+    m_disassembler = disassembler;
+    m_callgraph = CallGraph::get(disassembler);
+
+    connect(m_callgraph.get(), &CallGraph::graphChanged, this, [&]() {
+        if(m_requested) // Never shown, built on demand
+            this->build();
+    });
+}
+
+bool ProgramGraphView::isBuilt() const { return m_requested; }
+
+void ProgramGraphView::build()
+{
+    if(!m_callgraph)
+        return;
+
+    m_requested = true; // Follows the call graph from now on
+    CallGraph::GraphPtr callgraph = m_callgraph->graph();
+
+    if(!callgraph) // Still building, 'graphChanged' comes next
+    {
+        this->viewport()->update();
+        return;
+    }
+
+    if(m_building) // Changed while building
+    {
+        m_rebuild = true;
+        return;
+    }
+
+    m_building = true;
+    m_layout->stop();
+
+    REDasm::DisassemblerPtr disassembler = m_disassembler;
+    auto* watcher = new QFutureWatcher<ProgramGraph>(this);
+
+    connect(watcher, &QFutureWatcher<ProgramGraph>::finished, this, [=]() {
+        m_building = false;
+        this->setProgramGraph(watcher->result());
+        watcher->deleteLater();
+
+        if(!m_rebuild)
+            return;
+
+        m_rebuild = false;
+        this->build();
+    });
+
+    watcher->setFuture(QtConcurrent::run([=]() -> ProgramGraph { return ProgramGraph::build(disassembler, callgraph.get()); }));
+    this->viewport()->update();
+}
+
+void ProgramGraphView::expandCluster(int cluster)
+{
+    if((cluster < 0) || (cluster >= m_collapsed.size()) || !m_collapsed[cluster])
+        return;
+
+    m_collapsed[cluster] = false;
+    this->updateVisibleGraph();
+}
+
+void ProgramGraphView::collapseCluster(int cluster)
+{
+    if((cluster < 0) || (cluster >= m_collapsed.size()) || m_collapsed[cluster])
+        return;
+
+    m_collapsed[cluster] = true;
+    this->updateVisibleGraph();
+}
+
+void ProgramGraphView::contextMenuEvent(QContextMenuEvent *e)
+{
+    int idx = this->nodeAt(e->pos());
+
+    if(idx == -1)
+        return;
+
+    const Node& node = m_nodes[idx];
+    QString clustername = m_graph.clusternames[node.cluster];
+    QMenu menu(this);
+
+    if(node.base == -1)
+        menu.addAction(QString("Expand %1").arg(clustername), this, [=]() { this->expandCluster(node.cluster); });
+    else
+    {
+        address_t address = m_graph.addresses[node.base];
+        menu.addAction(QString("Go to %1").arg(node.label), this, [=]() { emit functionActivated(address); });
+        menu.addAction(QString("Collapse %1").arg(clustername), this, [=]() { this->collapseCluster(node.cluster); });
+    }
+
+    menu.exec(e->globalPos());
+}
+
+void ProgramGraphView::mouseDoubleClickEvent(QMouseEvent *e)
+{
+    int idx = this->nodeAt(e->pos());
+
+    if((idx == -1) || (e->button() != Qt::LeftButton))
+        return;
+
+    if(m_nodes[idx].base == -1)
+        this->expandCluster(m_nodes[idx].cluster);
+    else
+        emit functionActivated(m_graph.addresses[m_nodes[idx].base]);
+}
+
+void ProgramGraphView::mousePressEvent(QMouseEvent *e)
+{
+    if(e->button() != Qt::LeftButton)
+        return;
+
+    int idx = this->nodeAt(e->pos());
+
+    if(idx != m_selectednode)
+    {
+        m_selectednode = idx;
+        this->updateHighlightedEdges();
+        this->viewport()->update();
+    }
+
+    if(idx != -1)
+        return;
+
+    m_scrollmode = true;
+    m_scrollbase = e->pos();
+    this->setCursor(Qt::ClosedHandCursor);
+}
+
+void ProgramGraphView::mouseReleaseEvent(QMouseEvent *e)
+{
+    if((e->button() != Qt::LeftButton) || !m_scrollmode)
+        return;
+
+    m_scrollmode = false;
+    this->setCursor(Qt::ArrowCursor);
+}
+
+void ProgramGraphView::mouseMoveEvent(QMouseEvent *e)
+{
+    if(!m_scrollmode)
+        return;
+
+    QPoint delta = e->pos() - m_scrollbase;
+    m_scrollbase = e->pos();
+    m_center -= QPointF(delta) / m_scale;
+    m_autofit = false;
+    this->viewport()->update();
+}
+
+void ProgramGraphView::wheelEvent(QWheelEvent *e)
+{
+    if(e->modifiers() & Qt::ControlModifier)
+        this->zoom(e->delta() > 0 ? ZOOM_STEP : (1 / ZOOM_STEP), e->pos());
+    else if(e->modifiers() & Qt::ShiftModifier)
+        m_center.rx() -= e->delta() / m_scale;
+    else
+        m_center.ry() -= e->delta() / m_scale;
+
+    m_autofit = false;
+    this->viewport()->update();
+    e->accept();
+}
+
+void ProgramGraphView::paintEvent(QPaintEvent *e)
+{
+    QPainter painter(this->viewport());
+
+    if(m_nodes.empty())
+    {
+        if(m_requested)
+            painter.drawText(this->viewport()->rect(), Qt::AlignCenter, "Building call graph...");
+
+        return;
+    }
+
+    QPoint translation = this->translation();
+
+    if(m_layout->isRunning()) // Positions change at every refresh, tiles are useless here
+    {
+        QRectF scenerect(QPointF(e->rect().topLeft() - translation) / m_scale, QSizeF(e->rect().size()) / m_scale);
+        QVector<int> nodes;
+
+        for(int i = 0; i < m_nodes.size(); i++)
+        {
+            if(scenerect.intersects(this->nodeRect(i)))
+                nodes.push_back(i);
+        }
+
+        painter.save();
+        painter.translate(translation);
+        painter.scale(m_scale, m_scale);
+        m_edges.render(&painter, GraphViewEdges::Solid);
+        this->renderNodes(&painter, nodes, m_scale);
+        painter.restore();
+    }
+    else
+        this->renderTiles(&painter, translation, e->rect());
+
+    if(m_selectednode == -1)
+        return;
+
+    painter.translate(translation);
+    painter.scale(m_scale, m_scale);
+    m_highlightededges.render(&painter, GraphViewEdges::Highlighted);
+
+    QRectF r = this->nodeRect(m_selectednode);
+    painter.fillRect(r, THEME_VALUE("highlight_bg"));
+    painter.setPen(THEME_VALUE("highlight_fg"));
+    painter.drawText(r, Qt::AlignCenter, m_nodes[m_selectednode].label);
+}
+
+void ProgramGraphView::timerEvent(QTimerEvent *e)
+{
+    if(e->timerId() != m_refreshtimer)
+        return;
+
+    if(m_layout->takePositions(m_positions))
+    {
+        this->updateGeometry();
+
+        if(m_autofit)
+            this->fitScene();
+
+        this->viewport()->update();
+    }
+    else if(!m_layout->isRunning())
+    {
+        this->killTimer(m_refreshtimer);
+        m_refreshtimer = 0;
+        this->viewport()->update(); // Switch to tiles
+    }
+}
+
+void ProgramGraphView::setProgramGraph(const ProgramGraph &graph)
+{
+    // A rebuild keeps the layout of the functions that are still there and the state of the clusters
+    QHash<address_t, QPointF> oldpositions;
+    QHash<QString, bool> oldcollapsed;
+
+    for(int i = 0; i < m_visiblenode.size(); i++)
+        oldpositions[m_graph.addresses[i]] = m_positions[m_visiblenode[i]];
+
+    for(int i = 0; i < m_collapsed.size(); i++)
+        oldcollapsed[m_graph.clusternames[i]] = m_collapsed[i];
+
+    m_graph = graph;
+    m_collapsed.clear();
+
+    for(const QString& clustername : m_graph.clusternames)
+        m_collapsed.push_back(oldcollapsed.value(clustername, (m_graph.nodesCount() > COLLAPSE_THRESHOLD) && (m_graph.clusternames.size() > 1)));
+
+    m_nodes.clear();
+    m_positions.clear();
+    m_visiblenode.clear();
+
+    if(oldpositions.empty())
+        m_autofit = true;
+    else
+    {
+        QPointF last = oldpositions.begin().value();
+
+        // Seed the previous layout: new functions are placed next to their predecessor
+        for(int i = 0; i < m_graph.nodesCount(); i++)
+        {
+            auto it = oldpositions.find(m_graph.addresses[i]);
+            bool known = (it != oldpositions.end());
+
+            if(known)
+                last = it.value();
+
+            m_visiblenode.push_back(i);
+            m_positions.push_back(last);
+            m_nodes.push_back({ known ? i : -1, m_graph.clusters[i], 1, QString(), QSizeF() });
+        }
+    }
+
+    REDasm::log("Call graph: " + std::to_string(m_graph.nodesCount()) + " function(s), " + std::to_string(m_graph.edgesCount()) + " call(s)");
+    this->updateVisibleGraph();
+}
+
+void ProgramGraphView::updateVisibleGraph()
+{
+    QVector<QPointF> oldpositions = m_positions;
+    QVector<int> oldvisiblenode = m_visiblenode;
+    QVector<Node> oldnodes = m_nodes;
+    QFontMetrics fm = this->fontMetrics();
+
+    m_nodes.clear();
+    m_positions.clear();
+    m_selectednode = -1;
+    m_visiblenode = QVector<int>(m_graph.nodesCount(), -1);
+    m_clusternode = QVector<int>(m_graph.clusternames.size(), -1);
+
+    for(int i = 0; i < m_graph.nodesCount(); i++)
+    {
+        int cluster = m_graph.clusters[i];
+
+        if(m_collapsed[cluster])
+        {
+            int& clusternode = m_clusternode[cluster];
+
+            if(clusternode == -1)
+            {
+                clusternode = m_nodes.size();
+                m_nodes.push_back({ -1, cluster, 0, QString(), QSizeF() });
+                m_positions.push_back(QPointF());
+            }
+
+            m_visiblenode[i] = clusternode;
+            m_nodes[clusternode].members++;
+        }
+        else
+        {
+            QString label = fm.elidedText(m_graph.names[i], Qt::ElideRight, NODE_MAX_WIDTH);
+            m_visiblenode[i] = m_nodes.size();
+            m_nodes.push_back({ i, cluster, 1, label, QSizeF(fm.width(label) + (NODE_PADDING * 2), fm.height() + (NODE_PADDING * 2)) });
+            m_positions.push_back(QPointF());
+        }
+    }
+
+    // Start from the previous layout: only the changed neighborhood has to be refined
+    bool warm = !oldpositions.empty();
+    qreal radius = PROGRAMGRAPH_NODE_DISTANCE * std::sqrt(static_cast<qreal>(m_graph.nodesCount())) / 2;
+    QVector<int> placed(m_graph.clusternames.size(), 0);
+
+    for(int i = 0; i < m_graph.nodesCount(); i++)
+    {
+        int idx = m_visiblenode[i];
+        Node& node = m_nodes[idx];
+        QPointF center;
+
+        if(warm)
+            center = oldpositions[oldvisiblenode[i]];
+        else
+        {
+            qreal a = (2 * M_PI * node.cluster) / m_graph.clusternames.size();
+            center = (m_graph.clusternames.size() > 1) ? QPointF(radius * std::cos(a), radius * std::sin(a)) : QPointF();
+        }
+
+        if(node.base == -1) // Cluster's centroid
+            m_positions[idx] += center / node.members;
+        else if(!warm || (oldnodes[oldvisiblenode[i]].base == -1))
+            m_positions[idx] = center + spiral(placed[node.cluster]++, PROGRAMGRAPH_NODE_DISTANCE / 2);
+        else
+            m_positions[idx] = center;
+    }
+
+    for(Node& node : m_nodes)
+    {
+        if(node.base != -1)
+            continue;
+
+        node.label = QString("%1 (%2 functions)").arg(m_graph.clusternames[node.cluster]).arg(node.members);
+        node.size = QSizeF(fm.width(node.label) + (NODE_PADDING * 4), (fm.height() + NODE_PADDING) * 3);
+    }
+
+    // Calls between visible nodes, merged when they fall in the same collapsed cluster
+    QSet<quint64> edges;
+    QVector<int> degree(m_nodes.size(), 0);
+    m_edgesource.clear();
+    m_edgetarget.clear();
+
+    for(int i = 0; i < m_graph.nodesCount(); i++)
+    {
+        for(int j = m_graph.edgeoffsets[i]; j < m_graph.edgeoffsets[i + 1]; j++)
+        {
+            int source = m_visiblenode[i], target = m_visiblenode[m_graph.edgetargets[j]];
+
+            if((source == target) || edges.contains((static_cast<quint64>(source) << 32) | static_cast<quint32>(target)))
+                continue;
+
+            edges.insert((static_cast<quint64>(source) << 32) | static_cast<quint32>(target));
+            m_edgesource.push_back(source);
+            m_edgetarget.push_back(target);
+            degree[source]++;
+            degree[target]++;
+        }
+    }
+
+    QColor edgecolor = THEME_VALUE("graph_edge");
+
+    if(m_edgesource.size() > DENSE_EDGES)
+        edgecolor.setAlpha(80);
+
+    m_edges.clear();
+    m_edges.group(edgecolor);
+    m_highlightededges.clear();
+    m_highlightededges.group(THEME_VALUE("graph_edge_true"));  // Callees
+    m_highlightededges.group(THEME_VALUE("graph_edge_false")); // Callers
+
+    this->updateGeometry();
+    this->startLayout(warm ? (PROGRAMGRAPH_NODE_DISTANCE * 4) : radius);
+}
+
+void ProgramGraphView::updateGeometry()
+{
+    QVector<QLine>& lines = m_edges.lines[0];
+    lines.resize(m_edgesource.size());
+
+    for(int i = 0; i < m_edgesource.size(); i++)
+        lines[i] = QLineF(m_positions[m_edgesource[i]], m_positions[m_edgetarget[i]]).toLine();
+
+    m_scenerect = QRectF();
+
+    for(int i = 0; i < m_nodes.size(); i++)
+        m_scenerect |= this->nodeRect(i);
+
+    m_scenerect.adjust(-PROGRAMGRAPH_NODE_DISTANCE, -PROGRAMGRAPH_NODE_DISTANCE, PROGRAMGRAPH_NODE_DISTANCE, PROGRAMGRAPH_NODE_DISTANCE);
+    m_nodecells.clear(); // Rebuilt by the next tile request
+    m_edgecells.clear();
+    m_tiles->clear();
+    this->updateHighlightedEdges();
+}
+
+void ProgramGraphView::updateHighlightedEdges()
+{
+    m_highlightededges.clearGeometry();
+
+    if(m_selectednode == -1)
+        return;
+
+    const QVector<QLine>& lines = m_edges.lines[0];
+
+    for(int i = 0; i < m_edgesource.size(); i++)
+    {
+        if(m_edgesource[i] == m_selectednode)
+            m_highlightededges.lines[0].push_back(lines[i]);
+        else if(m_edgetarget[i] == m_selectednode)
+            m_highlightededges.lines[1].push_back(lines[i]);
+    }
+}
+
+void ProgramGraphView::startLayout(qreal temperature)
+{
+    ProgramGraphLayout::Input input;
+    input.positions = m_positions;
+    input.temperature = temperature;
+    input.adjoffsets = QVector<int>(m_nodes.size() + 1, 0);
+    input.adjacency.resize(m_edgesource.size() * 2);
+
+    for(const Node& node : m_nodes)
+        input.masses.push_back(node.members);
+
+    for(int i = 0; i < m_edgesource.size(); i++)
+    {
+        input.adjoffsets[m_edgesource[i] + 1]++;
+        input.adjoffsets[m_edgetarget[i] + 1]++;
+    }
+
+    for(int i = 0; i < m_nodes.size(); i++)
+        input.adjoffsets[i + 1] += input.adjoffsets[i];
+
+    QVector<int> fill = input.adjoffsets;
+
+    for(int i = 0; i < m_edgesource.size(); i++)
+    {
+        input.adjacency[fill[m_edgesource[i]]++] = m_edgetarget[i];
+        input.adjacency[fill[m_edgetarget[i]]++] = m_edgesource[i];
+    }
+
+    m_layout->start(input);
+
+    if(!m_refreshtimer)
+        m_refreshtimer = this->startTimer(REFRESH_INTERVAL);
+
+    this->viewport()->update();
+}
+
+void ProgramGraphView::fitScene()
+{
+    if(m_scenerect.isEmpty())
+        return;
+
+    QSizeF vpsize = this->viewport()->size();
+    m_center = m_scenerect.center();
+    m_scale = qBound(SCALE_MIN, std::min(vpsize.width() / m_scenerect.width(), vpsize.height() / m_scenerect.height()), SCALE_MAX);
+}
+
+void ProgramGraphView::zoom(qreal factor, const QPoint &cursorpos)
+{
+    QPointF scenepos = QPointF(cursorpos - this->translation()) / m_scale;
+    m_scale = qBound(SCALE_MIN, m_scale * factor, SCALE_MAX);
+
+    QPointF vpcenter(this->viewport()->width() / 2.0, this->viewport()->height() / 2.0);
+    m_center = scenepos - ((QPointF(cursorpos) - vpcenter) / m_scale); // Keep the point under the cursor
+}
+
+void ProgramGraphView::updateGrid()
+{
+    m_nodecells = QVector< QVector<int> >(GRID_CELLS * GRID_CELLS);
+    m_edgecells = QVector< QVector<int> >(GRID_CELLS * GRID_CELLS);
+
+    for(int i = 0; i < m_nodes.size(); i++)
+    {
+        QRect cells = this->gridCells(this->nodeRect(i));
+
+        for(int y = cells.top(); y <= cells.bottom(); y++)
+        {
+            for(int x = cells.left(); x <= cells.right(); x++)
+                m_nodecells[(y * GRID_CELLS) + x].push_back(i);
+        }
+    }
+
+    const QVector<QLine>& lines = m_edges.lines[0];
+    qreal cellwidth = m_scenerect.width() / GRID_CELLS, cellheight = m_scenerect.height() / GRID_CELLS;
+
+    for(int i = 0; i < lines.size(); i++) // Walked a column at a time: only the cells the line crosses
+    {
+        QPointF p1 = (QPointF(lines[i].p1()) - m_scenerect.topLeft()), p2 = (QPointF(lines[i].p2()) - m_scenerect.topLeft());
+        p1 = QPointF(p1.x() / cellwidth, p1.y() / cellheight);
+        p2 = QPointF(p2.x() / cellwidth, p2.y() / cellheight);
+
+        if(p1.x() > p2.x())
+            std::swap(p1, p2);
+
+        qreal dx = p2.x() - p1.x();
+
+        for(int x = qBound(0, static_cast<int>(std::floor(p1.x())), GRID_CELLS - 1); x <= qBound(0, static_cast<int>(std::floor(p2.x())), GRID_CELLS - 1); x++)
+        {
+            qreal xa = std::max(p1.x(), static_cast<qreal>(x)), xb = std::min(p2.x(), static_cast<qreal>(x + 1));
+            qreal ya = qFuzzyIsNull(dx) ? p1.y() : p1.y() + ((xa - p1.x()) * (p2.y() - p1.y()) / dx);
+            qreal yb = qFuzzyIsNull(dx) ? p2.y() : p1.y() + ((xb - p1.x()) * (p2.y() - p1.y()) / dx);
+            int y1 = qBound(0, static_cast<int>(std::floor(std::min(ya, yb))), GRID_CELLS - 1);
+            int y2 = qBound(0, static_cast<int>(std::floor(std::max(ya, yb))), GRID_CELLS - 1);
+
+            for(int y = y1; y <= y2; y++)
+                m_edgecells[(y * GRID_CELLS) + x].push_back(i);
+        }
+    }
+}
+
+QRect ProgramGraphView::gridCells(const QRectF &scenerect) const
+{
+    qreal cellwidth = m_scenerect.width() / GRID_CELLS, cellheight = m_scenerect.height() / GRID_CELLS;
+    QPointF p1 = scenerect.topLeft() - m_scenerect.topLeft(), p2 = scenerect.bottomRight() - m_scenerect.topLeft();
+
+    return QRect(QPoint(qBound(0, static_cast<int>(std::floor(p1.x() / cellwidth)), GRID_CELLS - 1), qBound(0, static_cast<int>(std::floor(p1.y() / cellheight)), GRID_CELLS - 1)),
+                 QPoint(qBound(0, static_cast<int>(std::floor(p2.x() / cellwidth)), GRID_CELLS - 1), qBound(0, static_cast<int>(std::floor(p2.y() / cellheight)), GRID_CELLS - 1)));
+}
+
+QVector<int> ProgramGraphView::cellItems(const QVector< QVector<int> >& grid, const QRectF &scenerect) const
+{
+    QRect cells = this->gridCells(scenerect);
+    QVector<int> items;
+
+    for(int y = cells.top(); y <= cells.bottom(); y++)
+    {
+        for(int x = cells.left(); x <= cells.right(); x++)
+            items += grid[(y * GRID_CELLS) + x];
+    }
+
+    std::sort(items.begin(), items.end()); // Items crossing more cells are listed once
+    items.erase(std::unique(items.begin(), items.end()), items.end());
+    return items;
+}
+
+void ProgramGraphView::renderNodes(QPainter *painter, const QVector<int>& nodes, qreal scale) const
+{
+    bool labels = (scale * this->fontMetrics().height()) >= LOD_MIN_TEXT_HEIGHT;
+    QColor functioncolor = THEME_VALUE("function_fg"), clustercolor = THEME_VALUE("segment_fg");
+
+    painter->save();
+    painter->setFont(this->font());
+    painter->setBrush(this->palette().color(QPalette::Base));
+
+    for(int i : nodes)
+    {
+        QRectF r = this->nodeRect(i);
+        const QColor& c = (m_nodes[i].base == -1) ? clustercolor : functioncolor;
+
+        if(!labels) // Low LOD: just a filled box
+        {
+            painter->fillRect(r, c);
+            continue;
+        }
+
+        painter->setPen(c);
+        painter->drawRect(r);
+        painter->drawText(r, Qt::AlignCenter, m_nodes[i].label);
+    }
+
+    painter->restore();
+}
+
+void ProgramGraphView::renderTiles(QPainter *painter, const QPoint &translation, const QRect &exposedrect)
+{
+    QRect scenerect(QPointF(m_scenerect.topLeft() * m_scale).toPoint(), QSizeF(m_scenerect.size() * m_scale).toSize());
+    QRect visiblerect = exposedrect.translated(-translation) & scenerect;
+
+    if(visiblerect.isEmpty())
+        return;
+
+    if(m_nodecells.empty())
+        this->updateGrid();
+
+    int zoom = GraphViewTileCache::zoomKey(m_scale);
+
+    for(int y = tileIndex(visiblerect.top()); y <= tileIndex(visiblerect.bottom()); y++)
+    {
+        for(int x = tileIndex(visiblerect.left()); x <= tileIndex(visiblerect.right()); x++)
+        {
+            GraphViewTileKey key = { zoom, x, y };
+            QRect tilerect = GraphViewTileCache::tileRect(key);
+            const QImage* tile = m_tiles->tile(key);
+
+            if(tile)
+            {
+                painter->drawImage(tilerect.topLeft() + translation, *tile);
+                continue;
+            }
+
+            if(!m_tiles->isPending(key)) // The background stays until the worker delivers it
+                m_tiles->request(key, this->snapshot(QRectF(QPointF(tilerect.topLeft()) / m_scale, QSizeF(tilerect.size()) / m_scale)), m_scale);
+        }
+    }
+}
+
+GraphViewSnapshot ProgramGraphView::snapshot(const QRectF &scenerect) const
+{
+    GraphViewSnapshot snapshot;
+    snapshot.background = this->palette().color(QPalette::Base);
+    snapshot.dpi = this->viewport()->logicalDpiX();
+
+    snapshot.edges = m_edges; // Same colours and pens, only the edges crossing 'scenerect'
+    snapshot.edges.clearGeometry();
+
+    for(int i : this->cellItems(m_edgecells, scenerect))
+    {
+        const QLine& line = m_edges.lines[0][i];
+
+        if(scenerect.intersects(QRectF(line.p1(), line.p2()).normalized().adjusted(-1, -1, 1, 1)))
+            snapshot.edges.lines[0].push_back(line);
+    }
+
+    if(snapshot.edges.lines[0].empty())
+        snapshot.edges.clear();
+
+    QVector<int> nodes;
+
+    for(int i : this->cellItems(m_nodecells, scenerect))
+    {
+        if(scenerect.intersects(this->nodeRect(i)))
+            nodes.push_back(i);
+    }
+
+    QPicture picture;
+    QPainter painter(&picture);
+    painter.setPen(this->viewport()->palette().color(this->viewport()->foregroundRole()));
+    this->renderNodes(&painter, nodes, m_scale);
+    painter.end();
+
+    snapshot.blocks.push_back({ scenerect.toAlignedRect(), picture });
+    return snapshot;
+}
+
+QRectF ProgramGraphView::nodeRect(int idx) const
+{
+    const QSizeF& size = m_nodes[idx].size;
+    const QPointF& p = m_positions[idx];
+    return QRectF(p.x() - (size.width() / 2), p.y() - (size.height() / 2), size.width(), size.height());
+}
+
+QPoint ProgramGraphView::translation() const
+{
+    QPointF vpcenter(this->viewport()->width() / 2.0, this->viewport()->height() / 2.0);
+    return (vpcenter - (m_center * m_scale)).toPoint();
+}
+
+int ProgramGraphView::nodeAt(const QPoint &pos) const
+{
+    QPointF scenepos = QPointF(pos - this->translation()) / m_scale;
+
+    for(int i = m_nodes.size() - 1; i >= 0; i--) // Topmost first
+    {
+        if(this->nodeRect(i).contains(scenepos))
+            return i;
+    }
+
+    return -1;
+}
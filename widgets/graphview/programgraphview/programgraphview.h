@@ -0,0 +1,83 @@
+#ifndef PROGRAMGRAPHVIEW_H
+#define PROGRAMGRAPHVIEW_H
+
+#include <QAbstractScrollArea>
+#include <QVector>
+#include <redasm/disassembler/disassemblerapi.h>
+#include "../graphviewtilecache.h"
+#include "programgraphlayout.h"
+#include "programgraph.h"
+
+// Whole program call graph: functions are clustered by segment (big segments are split),
+// big programs start with every cluster collapsed into a single node.
+// It follows the shared CallGraph, keeping the layout of what is still there on every rebuild.
+class ProgramGraphView : public QAbstractScrollArea
+{
+    Q_OBJECT
+
+    public:
+        explicit ProgramGraphView(QWidget *parent = nullptr);
+        void setDisassembler(const REDasm::DisassemblerPtr& disassembler);
+        bool isBuilt() const;
+
+    public slots:
+        void build();
+        void expandCluster(int cluster);
+        void collapseCluster(int cluster);
+
+    signals:
+        void functionActivated(address_t address);
+
+    protected:
+        void contextMenuEvent(QContextMenuEvent* e) override;
+        void mouseDoubleClickEvent(QMouseEvent* e) override;
+        void mousePressEvent(QMouseEvent* e) override;
+        void mouseReleaseEvent(QMouseEvent* e) override;
+        void mouseMoveEvent(QMouseEvent* e) override;
+        void wheelEvent(QWheelEvent* e) override;
+        void paintEvent(QPaintEvent* e) override;
+        void timerEvent(QTimerEvent* e) override;
+
+    private:
+        struct Node { int base, cluster, members; QString label; QSizeF size; }; // 'base' is -1 for collapsed clusters
+
+    private:
+        void setProgramGraph(const ProgramGraph& graph);
+        void updateVisibleGraph();
+        void updateGeometry();
+        void updateHighlightedEdges();
+        void startLayout(qreal temperature);
+        void fitScene();
+        void zoom(qreal factor, const QPoint& cursorpos);
+        void updateGrid();
+        QRect gridCells(const QRectF& scenerect) const;
+        QVector<int> cellItems(const QVector< QVector<int> >& grid, const QRectF& scenerect) const;
+        void renderNodes(QPainter* painter, const QVector<int>& nodes, qreal scale) const;
+        void renderTiles(QPainter* painter, const QPoint& translation, const QRect& exposedrect);
+        GraphViewSnapshot snapshot(const QRectF& scenerect) const;
+        QRectF nodeRect(int idx) const;
+        QPoint translation() const;
+        int nodeAt(const QPoint& pos) const;
+
+    private:
+        REDasm::DisassemblerPtr m_disassembler;
+        std::shared_ptr<CallGraph> m_callgraph;
+        ProgramGraphLayout* m_layout;
+        GraphViewTileCache* m_tiles;
+        ProgramGraph m_graph;
+        GraphViewEdges m_edges, m_highlightededges;
+        QVector<Node> m_nodes;
+        QVector<QPointF> m_positions;
+        QVector<int> m_visiblenode, m_clusternode; // Function/cluster -> visible node
+        QVector<int> m_edgesource, m_edgetarget;
+        QVector<bool> m_collapsed;
+        QVector< QVector<int> > m_nodecells, m_edgecells; // Scene grid, built when tiles are needed
+        QRectF m_scenerect;
+        QPointF m_center;
+        QPoint m_scrollbase;
+        qreal m_scale;
+        int m_selectednode, m_refreshtimer;
+        bool m_building, m_requested, m_rebuild, m_scrollmode, m_autofit;
+};
+
+#endif // PROGRAMGRAPHVIEW_H
@@ -0,0 +1,19 @@
+#ifndef WORKCHUNKS_H
+#define WORKCHUNKS_H
+
+#include <QVector>
+#include <QPair>
+#include <algorithm>
+
+// Splits [first, last) in ranges of 'size' items: the unit of work of the QtConcurrent workers
+template<typename T> QVector< QPair<T, T> > workChunks(T first, T last, T size)
+{
+    QVector< QPair<T, T> > chunks;
+
+    for(T i = first; i < last; i += size)
+        chunks.push_back(qMakePair(i, std::min(i + size, last)));
+
+    return chunks;
+}
+
+#endif // WORKCHUNKS_H